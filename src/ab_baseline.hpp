@@ -0,0 +1,46 @@
+#ifndef AB_BASELINE_HPP
+#define AB_BASELINE_HPP
+
+// The baseline SBOVector as sbovector_baseline::SBOVector, next to the current ::SBOVector
+//
+// sbovector_baseline.hpp is src/sbovector.hpp at the git ref SBOVECTOR_AB_BASELINE, with its
+// include guard renamed, written to the build tree at configure time (see src/CMakeLists.txt).
+
+#include "sbovector.hpp"
+
+// every standard header the snapshot may include: already included, their guards keep them
+// out of the namespace below
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <exception>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// defined unconditionally by the header, the snapshot's definitions must not leak past it
+#pragma push_macro("SBOVECTOR_NOEXCEPT_COND_ALLOC")
+#pragma push_macro("SBOVECTOR_DO_BAD_ALLOC_THROW")
+#pragma push_macro("SBOVEC_OOM")
+#pragma push_macro("SBOVECTOR_PROBE")
+#undef SBOVECTOR_NOEXCEPT_COND_ALLOC
+#undef SBOVECTOR_DO_BAD_ALLOC_THROW
+#undef SBOVEC_OOM
+#undef SBOVECTOR_PROBE
+
+namespace sbovector_baseline {
+#include "sbovector_baseline.hpp"
+}  // namespace sbovector_baseline
+
+#pragma pop_macro("SBOVECTOR_PROBE")
+#pragma pop_macro("SBOVEC_OOM")
+#pragma pop_macro("SBOVECTOR_DO_BAD_ALLOC_THROW")
+#pragma pop_macro("SBOVECTOR_NOEXCEPT_COND_ALLOC")
+
+#endif  // AB_BASELINE_HPP
@@ -0,0 +1,275 @@
+#include "ab_baseline.hpp"
+#include "benchmark_common.hpp"
+#include "sbovector.hpp"
+#include "test_types.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// The current SBOVector against a baseline snapshot of sbovector.hpp (sbovector_baseline.hpp,
+// built with -DSBOVECTOR_AB_BASELINE=<git ref>), in one binary
+//
+// Every benchmark is a pair of slots registered next to each other and the whole set runs
+// --ab_rounds times, one sample per slot per round. Slot 0 runs the current version on even
+// rounds and the baseline on odd ones (slot 1 the opposite), so slow machine drift hits both
+// versions alike and neither always runs first. Alternating cannot cancel a fixed code layout
+// bias (a hot loop straddling a cache line on one side only, moved by an unrelated change):
+// the target is built in Release with functions and loops aligned to 64 bytes (see
+// src/CMakeLists.txt). No console table: samples go to --ab_out as JSON, judged by
+// tools/ab/compare.py, eg:
+//   ab_benchmarks --ab_rounds=20 --ab_out=ab.json --benchmark_filter='PushBack'
+//   tools/ab/compare.py ab.json --threshold 0.05
+// Containers allocate through BenchmarkCountingAllocator, so "allocs" is compared too.
+
+namespace {
+
+template <typename T>
+using Current = SBOVector<T, 16, BenchmarkCountingAllocator<T>>;
+template <typename T>
+using Baseline = sbovector_baseline::SBOVector<T, 16, BenchmarkCountingAllocator<T>>;
+
+// inline, full inline, crossing BufferSize, spilled
+constexpr int64_t kSizes[] = {8, 16, 17, 64};
+
+int g_round = 0;
+
+template <typename ContainerType>
+void Consume(const ContainerType& container) {
+  for (const auto& element : container) {
+    benchmark::DoNotOptimize(element);
+  }
+}
+
+template <typename ContainerType>
+void AB_PushBack(benchmark::State& state) {
+  using DataType = typename ContainerType::value_type;
+  const auto count = static_cast<size_t>(state.range(0));
+  const DataType value{};
+  ScopedAllocationCounters allocation_counters(state);
+  for (auto _ : state) {
+    ContainerType c;
+    for (auto i = 0u; i < count; ++i) {
+      c.push_back(value);
+    }
+    benchmark::DoNotOptimize(c.data());
+  }
+  allocation_counters.Report(state);
+}
+
+template <typename ContainerType>
+void AB_CopyConstruct(benchmark::State& state) {
+  using DataType = typename ContainerType::value_type;
+  const ContainerType original(static_cast<size_t>(state.range(0)), DataType{});
+  ScopedAllocationCounters allocation_counters(state);
+  for (auto _ : state) {
+    ContainerType copy(original);
+    benchmark::DoNotOptimize(copy.data());
+  }
+  allocation_counters.Report(state);
+}
+
+template <typename ContainerType>
+void AB_Iterate(benchmark::State& state) {
+  using DataType = typename ContainerType::value_type;
+  const ContainerType c(static_cast<size_t>(state.range(0)), DataType{});
+  ScopedAllocationCounters allocation_counters(state);
+  for (auto _ : state) {
+    Consume(c);
+  }
+  allocation_counters.Report(state);
+}
+
+template <typename ContainerType>
+void AB_InsertFront(benchmark::State& state) {
+  using DataType = typename ContainerType::value_type;
+  const auto count = static_cast<size_t>(state.range(0));
+  const DataType value{};
+  ScopedAllocationCounters allocation_counters(state);
+  for (auto _ : state) {
+    ContainerType c;
+    for (auto i = 0u; i < count; ++i) {
+      c.insert(c.begin(), value);
+    }
+    benchmark::DoNotOptimize(c.data());
+  }
+  allocation_counters.Report(state);
+}
+
+template <typename ContainerType>
+void AB_EraseFront(benchmark::State& state) {
+  using DataType = typename ContainerType::value_type;
+  const auto count = static_cast<size_t>(state.range(0));
+  ScopedAllocationCounters allocation_counters(state);
+  for (auto _ : state) {
+    ContainerType c(count, DataType{});
+    for (auto i = 0u; i < count; ++i) {
+      c.erase(c.begin());
+    }
+    benchmark::DoNotOptimize(c.data());
+  }
+  allocation_counters.Report(state);
+}
+
+template <typename ContainerType>
+void AB_Resize(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  ContainerType c;
+  ScopedAllocationCounters allocation_counters(state);
+  for (auto _ : state) {
+    c.resize(count);
+    c.resize(count / 2);
+  }
+  allocation_counters.Report(state);
+}
+
+template <typename ContainerType>
+void AB_Swap(benchmark::State& state) {
+  using DataType = typename ContainerType::value_type;
+  ContainerType a(static_cast<size_t>(state.range(0)), DataType{});
+  ContainerType b(8, DataType{});
+  ScopedAllocationCounters allocation_counters(state);
+  for (auto _ : state) {
+    a.swap(b);
+  }
+  allocation_counters.Report(state);
+}
+
+using Function = void (*)(benchmark::State&);
+
+void RegisterPair(const std::string& name, int64_t size, Function current, Function baseline) {
+  for (int slot = 0; slot < 2; ++slot) {
+    const auto slot_name = std::to_string(slot) + "/" + name;
+    benchmark::RegisterBenchmark(slot_name.c_str(),
+                                 [=](benchmark::State& state) {
+                                   ((g_round + slot) % 2 ? baseline : current)(state);
+                                 })
+        ->Arg(size)
+        ->Unit(benchmark::kNanosecond);
+  }
+}
+
+#define AB_PAIR(OP, ELEMENT, SIZE) \
+  RegisterPair(#OP "<" #ELEMENT ">", SIZE, AB_##OP<Current<ELEMENT>>, AB_##OP<Baseline<ELEMENT>>)
+
+#define AB_ELEMENT_PAIRS(ELEMENT, SIZE) \
+  AB_PAIR(PushBack, ELEMENT, SIZE); \
+  AB_PAIR(CopyConstruct, ELEMENT, SIZE); \
+  AB_PAIR(Iterate, ELEMENT, SIZE); \
+  AB_PAIR(InsertFront, ELEMENT, SIZE); \
+  AB_PAIR(EraseFront, ELEMENT, SIZE); \
+  AB_PAIR(Resize, ELEMENT, SIZE); \
+  AB_PAIR(Swap, ELEMENT, SIZE)
+
+void RegisterPairs() {
+  for (auto size : kSizes) {
+    AB_ELEMENT_PAIRS(int, size);
+    AB_ELEMENT_PAIRS(NonTrivial, size);
+  }
+}
+
+std::string JsonEscaped(const std::string& in) {
+  std::string out;
+  for (auto c : in) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    out += c;
+  }
+  return out;
+}
+
+// Collects the samples of every round as JSON objects (slots resolved to variants)
+class SampleReporter : public benchmark::BenchmarkReporter {
+  std::vector<std::string> samples_;
+
+ public:
+  bool ReportContext(const Context&) override { return true; }
+
+  void ReportRuns(const std::vector<Run>& runs) override {
+    for (const auto& run : runs) {
+      if (run.error_occurred || run.run_type != Run::RT_Iteration) {
+        continue;
+      }
+      const auto name = run.benchmark_name();
+      const auto slot = name[0] - '0';
+      std::ostringstream sample;
+      sample << "{\"name\": \"" << JsonEscaped(name.substr(2)) << "\", \"variant\": \""
+             << ((g_round + slot) % 2 ? "baseline" : "current") << "\", \"round\": " << g_round
+             << ", \"real_ns\": " << run.GetAdjustedRealTime()
+             << ", \"cpu_ns\": " << run.GetAdjustedCPUTime()
+             << ", \"iterations\": " << static_cast<int64_t>(run.iterations)
+             << ", \"counters\": {";
+      auto first = true;
+      // (already per iteration where flagged kAvgIterations)
+      for (const auto& counter : run.counters) {
+        sample << (first ? "" : ", ") << "\"" << JsonEscaped(counter.first)
+               << "\": " << counter.second.value;
+        first = false;
+      }
+      sample << "}}";
+      samples_.push_back(sample.str());
+    }
+  }
+
+  void Write(std::ostream& out, int rounds) const {
+    out << "{\"rounds\": " << rounds << ", \"samples\": [\n";
+    for (size_t i = 0; i < samples_.size(); ++i) {
+      out << "  " << samples_[i] << (i + 1 < samples_.size() ? ",\n" : "\n");
+    }
+    out << "]}\n";
+  }
+};
+
+// removes --name=value from argv, returns whether it was there
+bool TakeFlag(int& argc, char** argv, const char* name, std::string& value) {
+  const auto length = std::strlen(name);
+  for (int i = 1; i < argc; ++i) {
+    if (std::strncmp(argv[i], name, length) == 0 && argv[i][length] == '=') {
+      value = argv[i] + length + 1;
+      for (int j = i; j + 1 < argc; ++j) {
+        argv[j] = argv[j + 1];
+      }
+      --argc;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::string rounds_flag = "12";
+  std::string out_path = "ab.json";
+  TakeFlag(argc, argv, "--ab_rounds", rounds_flag);
+  TakeFlag(argc, argv, "--ab_out", out_path);
+  const auto rounds = std::max(1, std::atoi(rounds_flag.c_str()));
+
+  RegisterPairs();
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+    return 1;
+  }
+
+  SampleReporter reporter;
+  for (g_round = 0; g_round < rounds; ++g_round) {
+    std::fprintf(stderr, "round %d/%d\n", g_round + 1, rounds);
+    benchmark::RunSpecifiedBenchmarks(&reporter);
+  }
+
+  std::ofstream out(out_path);
+  reporter.Write(out, rounds);
+  if (!out) {
+    std::fprintf(stderr, "failed to write %s\n", out_path.c_str());
+    return 1;
+  }
+  std::fprintf(stderr, "wrote %s\n", out_path.c_str());
+  return 0;
+}
@@ -0,0 +1,448 @@
+#ifndef BENCHMARK_COMMON_HPP
+#define BENCHMARK_COMMON_HPP
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Helpers shared between the benchmark translation units
+
+// Google Benchmark turned State::thread_index/threads into methods in 1.6,
+// these accept either
+template <typename State>
+auto ThreadIndex(const State& state) -> decltype(state.thread_index()) {
+  return state.thread_index();
+}
+template <typename State>
+auto ThreadIndex(const State& state) -> decltype(state.thread_index + 0) {
+  return state.thread_index;
+}
+
+template <typename State>
+auto ThreadCount(const State& state) -> decltype(state.threads()) {
+  return state.threads();
+}
+template <typename State>
+auto ThreadCount(const State& state) -> decltype(state.threads + 0) {
+  return state.threads;
+}
+
+// Resident set size helpers, Linux only (everything reports 0 elsewhere)
+namespace rss {
+
+namespace details_ {
+
+// reads a "Name:   1234 kB" line from /proc/self/status
+inline size_t ReadStatusKB(const char* name) {
+#if defined(__linux__)
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  const auto name_length = std::strlen(name);
+  while (std::getline(status, line)) {
+    if (line.compare(0, name_length, name) == 0 && line.size() > name_length &&
+        line[name_length] == ':') {
+      return std::stoul(line.substr(name_length + 1));
+    }
+  }
+#else
+  static_cast<void>(name);
+#endif
+  return 0;
+}
+
+}  // namespace details_
+
+// Returns freed heap memory to the system where the allocator supports it (glibc), so RSS
+// growth measured afterwards is not hidden by memory freed earlier in the process
+inline void ReleaseFreeMemory() {
+#if defined(__GLIBC__)
+  malloc_trim(0);
+#endif
+}
+
+inline size_t CurrentBytes() { return details_::ReadStatusKB("VmRSS") * 1024; }
+
+// Peak RSS since the process started or the last successful ResetPeak()
+inline size_t PeakBytes() { return details_::ReadStatusKB("VmHWM") * 1024; }
+
+// Resets the kernel's peak RSS tracking (/proc/self/clear_refs, Linux 4.0+),
+// returns false if unsupported in which case PeakBytes() stays process wide
+inline bool ResetPeak() {
+#if defined(__linux__)
+  auto clear_refs = std::fopen("/proc/self/clear_refs", "w");
+  if (!clear_refs) {
+    return false;
+  }
+  const auto ok = std::fputs("5", clear_refs) >= 0;
+  return (std::fclose(clear_refs) == 0) && ok;
+#else
+  return false;
+#endif
+}
+
+}  // namespace rss
+
+// Reports the RSS growth of a benchmark as "peak_rss_MB" (peak over the run)
+// and "rss_MB" (resident when Report is called)
+class ScopedRSSCounters {
+  size_t baseline_;
+  bool peak_valid_;
+
+ public:
+  ScopedRSSCounters() : baseline_(rss::CurrentBytes()), peak_valid_(rss::ResetPeak()) {}
+
+  void Report(benchmark::State& state) const {
+    constexpr double kMB = 1024.0 * 1024.0;
+    const auto current = rss::CurrentBytes();
+    state.counters["rss_MB"] =
+        static_cast<double>(current > baseline_ ? current - baseline_ : 0) / kMB;
+    if (peak_valid_) {
+      const auto peak = rss::PeakBytes();
+      state.counters["peak_rss_MB"] =
+          static_cast<double>(peak > baseline_ ? peak - baseline_ : 0) / kMB;
+    }
+  }
+};
+
+// Benchmarks needing GBs of memory or disk are left out of the default run, they are only
+// registered when SBOVECTOR_BENCHMARK_LARGE is set (and not "0")
+inline bool LargeBenchmarksEnabled() {
+  static const bool enabled = []() {
+    const auto env = std::getenv("SBOVECTOR_BENCHMARK_LARGE");
+    return env && *env && std::strcmp(env, "0") != 0;
+  }();
+  return enabled;
+}
+
+// Allocation counting, process wide so containers need no allocator state
+namespace allocations {
+
+struct Totals {
+  std::atomic<uint64_t> allocs_{0};
+  std::atomic<uint64_t> frees_{0};
+  std::atomic<uint64_t> bytes_allocated_{0};
+  std::atomic<uint64_t> live_bytes_{0};
+  std::atomic<uint64_t> peak_live_bytes_{0};
+};
+
+inline Totals& GlobalTotals() {
+  static Totals totals;
+  return totals;
+}
+
+inline void OnAllocate(size_t bytes) noexcept {
+  auto& totals = GlobalTotals();
+  totals.allocs_.fetch_add(1, std::memory_order_relaxed);
+  totals.bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+  const auto live = totals.live_bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  auto peak = totals.peak_live_bytes_.load(std::memory_order_relaxed);
+  while (peak < live &&
+         !totals.peak_live_bytes_.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+  }
+}
+
+inline void OnDeallocate(size_t bytes) noexcept {
+  auto& totals = GlobalTotals();
+  totals.frees_.fetch_add(1, std::memory_order_relaxed);
+  totals.live_bytes_.fetch_sub(bytes, std::memory_order_relaxed);
+}
+
+}  // namespace allocations
+
+// std::allocator counting into allocations::GlobalTotals(), safe from any thread
+// (the thread safe counterpart of the unittests' CountingAllocator)
+template <typename T>
+struct BenchmarkCountingAllocator {
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using size_type = size_t;
+
+  using is_always_equal = std::true_type;
+
+  template <typename U>
+  struct rebind {
+    using other = BenchmarkCountingAllocator<U>;
+  };
+
+  BenchmarkCountingAllocator() noexcept = default;
+
+  template <typename U>
+  BenchmarkCountingAllocator(const BenchmarkCountingAllocator<U>&) noexcept {}
+
+  pointer allocate(size_t n, const void*) { return allocate(n); }
+  pointer allocate(size_t n) {
+    auto p = std::allocator<T>().allocate(n);
+    allocations::OnAllocate(n * sizeof(T));
+    return p;
+  }
+
+  void deallocate(pointer p, size_t n) noexcept {
+    allocations::OnDeallocate(n * sizeof(T));
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template <typename U>
+  bool operator==(const BenchmarkCountingAllocator<U>&) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const BenchmarkCountingAllocator<U>&) const noexcept {
+    return false;
+  }
+};
+
+// Reports BenchmarkCountingAllocator activity since construction as per iteration "allocs",
+// "frees" and "bytes_allocated", and "peak_bytes": the most bytes live at once beyond those
+// live at construction. Includes work done with timing paused (eg: per iteration setup),
+// unless bracketed by Pause() / Resume(), construct it once setup shared by every iteration
+// is done. The totals are process wide: under threads pausing excludes every thread's
+// activity meanwhile, and only thread 0 resets the peak
+class ScopedAllocationCounters {
+  uint64_t allocs_;
+  uint64_t frees_;
+  uint64_t bytes_allocated_;
+  uint64_t baseline_live_bytes_;
+  // the peak of the sections already measured, beyond their baselines
+  uint64_t measured_peak_bytes_{0};
+  bool resets_peak_;
+  // totals at Pause()
+  bool paused_{false};
+  uint64_t paused_allocs_{0};
+  uint64_t paused_frees_{0};
+  uint64_t paused_bytes_allocated_{0};
+
+  void Start() {
+    auto& totals = allocations::GlobalTotals();
+    baseline_live_bytes_ = totals.live_bytes_.load(std::memory_order_relaxed);
+    if (resets_peak_) {
+      totals.peak_live_bytes_.store(baseline_live_bytes_, std::memory_order_relaxed);
+    }
+  }
+
+  uint64_t SectionPeakBytes() const {
+    const auto peak = allocations::GlobalTotals().peak_live_bytes_.load(std::memory_order_relaxed);
+    return peak > baseline_live_bytes_ ? peak - baseline_live_bytes_ : 0;
+  }
+
+  // the current total, or the one at Pause() while paused
+  uint64_t Total(const std::atomic<uint64_t>& total, uint64_t at_pause) const {
+    return paused_ ? at_pause : total.load(std::memory_order_relaxed);
+  }
+
+ public:
+  explicit ScopedAllocationCounters(const benchmark::State& state)
+      : resets_peak_(ThreadIndex(state) == 0) {
+    auto& totals = allocations::GlobalTotals();
+    allocs_ = totals.allocs_.load(std::memory_order_relaxed);
+    frees_ = totals.frees_.load(std::memory_order_relaxed);
+    bytes_allocated_ = totals.bytes_allocated_.load(std::memory_order_relaxed);
+    Start();
+  }
+
+  // activity until Resume() is left out
+  void Pause() {
+    const auto& totals = allocations::GlobalTotals();
+    paused_ = true;
+    paused_allocs_ = totals.allocs_.load(std::memory_order_relaxed);
+    paused_frees_ = totals.frees_.load(std::memory_order_relaxed);
+    paused_bytes_allocated_ = totals.bytes_allocated_.load(std::memory_order_relaxed);
+    measured_peak_bytes_ = std::max(measured_peak_bytes_, SectionPeakBytes());
+  }
+
+  void Resume() {
+    const auto& totals = allocations::GlobalTotals();
+    paused_ = false;
+    allocs_ += totals.allocs_.load(std::memory_order_relaxed) - paused_allocs_;
+    frees_ += totals.frees_.load(std::memory_order_relaxed) - paused_frees_;
+    bytes_allocated_ += totals.bytes_allocated_.load(std::memory_order_relaxed) -
+                        paused_bytes_allocated_;
+    Start();
+  }
+
+  // most bytes live at once while measured, beyond those live when the measure (re)started
+  [[nodiscard]] uint64_t PeakBytes() const {
+    return paused_ ? measured_peak_bytes_ : std::max(measured_peak_bytes_, SectionPeakBytes());
+  }
+
+  // per container (peak_bytes too) when each iteration runs containers_per_iteration of them
+  void Report(benchmark::State& state, int64_t containers_per_iteration = 1) const {
+    const auto& totals = allocations::GlobalTotals();
+    const auto containers = static_cast<double>(std::max<int64_t>(containers_per_iteration, 1));
+    const auto per_iteration = [containers](uint64_t count) {
+      return benchmark::Counter(static_cast<double>(count) / containers,
+                                benchmark::Counter::kAvgIterations);
+    };
+    state.counters["allocs"] = per_iteration(Total(totals.allocs_, paused_allocs_) - allocs_);
+    state.counters["frees"] = per_iteration(Total(totals.frees_, paused_frees_) - frees_);
+    state.counters["bytes_allocated"] =
+        per_iteration(Total(totals.bytes_allocated_, paused_bytes_allocated_) - bytes_allocated_);
+    state.counters["peak_bytes"] = static_cast<double>(PeakBytes()) / containers;
+  }
+};
+
+// Hardware counters of the calling thread (Linux perf_event_open, user space only), enabled by
+// running with SBOVECTOR_BENCHMARK_PERF=1. Events the kernel refuses (perf_event_paranoid,
+// containers, virtual machines without a PMU) are left out, a notice goes to stderr once.
+namespace perf {
+
+struct Event {
+  const char* name_;
+  uint32_t type_;
+  uint64_t config_;
+};
+
+#if defined(__linux__)
+constexpr uint64_t CacheReadMiss(uint64_t cache) {
+  return cache | (uint64_t{PERF_COUNT_HW_CACHE_OP_READ} << 8) |
+         (uint64_t{PERF_COUNT_HW_CACHE_RESULT_MISS} << 16);
+}
+
+constexpr std::array<Event, 6> kEvents = {{
+    {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    {"l1d_misses", PERF_TYPE_HW_CACHE, CacheReadMiss(PERF_COUNT_HW_CACHE_L1D)},
+    {"llc_misses", PERF_TYPE_HW_CACHE, CacheReadMiss(PERF_COUNT_HW_CACHE_LL)},
+    {"dtlb_misses", PERF_TYPE_HW_CACHE, CacheReadMiss(PERF_COUNT_HW_CACHE_DTLB)},
+}};
+#else
+constexpr std::array<Event, 0> kEvents = {};
+#endif
+
+inline bool Enabled() {
+  static const bool enabled = []() {
+    const auto env = std::getenv("SBOVECTOR_BENCHMARK_PERF");
+    return env && *env && std::strcmp(env, "0") != 0;
+  }();
+  return enabled;
+}
+
+}  // namespace perf
+
+// Reports perf::kEvents counted since construction per item processed (items_per_iteration
+// per benchmark iteration), nothing unless perf::Enabled(). Like ScopedAllocationCounters
+// work done with timing paused is included, unless bracketed by Pause() / Resume().
+class ScopedPerfCounters {
+  std::array<int, perf::kEvents.size()> fds_;
+
+#if defined(__linux__)
+  // value scaled by time enabled / time running when the PMU was multiplexed, -1 on failure
+  static double Read(int fd) {
+    uint64_t values[3] = {};
+    if (::read(fd, values, sizeof(values)) != static_cast<ssize_t>(sizeof(values)) ||
+        values[2] == 0) {
+      return -1;
+    }
+    return static_cast<double>(values[0]) * static_cast<double>(values[1]) /
+           static_cast<double>(values[2]);
+  }
+#endif
+
+  void Toggle(bool enable) const {
+#if defined(__linux__)
+    for (auto fd : fds_) {
+      if (fd >= 0) {
+        ::ioctl(fd, enable ? PERF_EVENT_IOC_ENABLE : PERF_EVENT_IOC_DISABLE, 0);
+      }
+    }
+#else
+    static_cast<void>(enable);
+#endif
+  }
+
+ public:
+  ScopedPerfCounters() {
+    fds_.fill(-1);
+#if defined(__linux__)
+    if (!perf::Enabled()) {
+      return;
+    }
+    size_t opened = 0;
+    for (size_t i = 0; i < fds_.size(); ++i) {
+      perf_event_attr attr;
+      std::memset(&attr, 0, sizeof(attr));
+      attr.size = sizeof(attr);
+      attr.type = perf::kEvents[i].type_;
+      attr.config = perf::kEvents[i].config_;
+      attr.disabled = 1;
+      attr.exclude_kernel = 1;
+      attr.exclude_hv = 1;
+      attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+      fds_[i] = static_cast<int>(::syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+      opened += fds_[i] >= 0;
+    }
+    static bool warned = false;
+    if (opened < fds_.size() && !warned) {
+      warned = true;
+      std::fprintf(stderr, "SBOVECTOR_BENCHMARK_PERF: %zu of %zu perf events unavailable%s\n",
+                   fds_.size() - opened, fds_.size(),
+                   opened ? "" : " (check /proc/sys/kernel/perf_event_paranoid)");
+    }
+    for (auto fd : fds_) {
+      if (fd >= 0) {
+        ::ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ::ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+      }
+    }
+#endif
+  }
+
+  ScopedPerfCounters(const ScopedPerfCounters&) = delete;
+  ScopedPerfCounters& operator=(const ScopedPerfCounters&) = delete;
+
+  ~ScopedPerfCounters() {
+#if defined(__linux__)
+    for (auto fd : fds_) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+#endif
+  }
+
+  void Pause() const { Toggle(false); }
+  void Resume() const { Toggle(true); }
+
+  void Report(benchmark::State& state, int64_t items_per_iteration) const {
+#if defined(__linux__)
+    const auto items = static_cast<double>(state.iterations()) *
+                       static_cast<double>(std::max<int64_t>(items_per_iteration, 1));
+    for (size_t i = 0; i < fds_.size(); ++i) {
+      if (fds_[i] < 0) {
+        continue;
+      }
+      ::ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+      const auto value = Read(fds_[i]);
+      if (value >= 0 && items > 0) {
+        state.counters[perf::kEvents[i].name_] = value / items;
+      }
+    }
+#else
+    static_cast<void>(state);
+    static_cast<void>(items_per_iteration);
+#endif
+  }
+};
+
+#endif  // BENCHMARK_COMMON_HPP
@@ -1,10 +1,16 @@
 #include <benchmark/benchmark.h>
 
+#include "benchmark_common.hpp"
 #include "sbovector.hpp"
+#include "test_types.hpp"
 
 #include <algorithm>
 #include <array>
+#include <chrono>
+#include <cstdint>
 #include <numeric>
+#include <string>
+#include <type_traits>
 #include <vector>
 
 // Some benchmarks to help with improving SBOVector,
@@ -13,35 +19,132 @@
 // and benchmark::DoNotOptimize has its limitations as to what it forces preservation of
 // in optimized builds so these benchmarks should be treated with heavy, heavy skepticism.
 
+// The benchmark matrix: every operation below for
+//   elements: int, Pod64, std::string (heap allocated), NonTrivial (unique_ptr wrapper), MoveOnly
+//   containers: Std (std::vector), SBO16 and Compact16 (both SBOVector storage modes)
+//   sizes: 8, 16 (inline), 17 (crossing BufferSize), 64, 256 (spilled)
+// registered grouped by operation, then element, then container, eg:
+//   BM_PushBack<SBO16<Pod64>>/17
+// so one slice runs with --benchmark_filter, eg:
+//   'BM_PushBack<'  '<Pod64>'  '<Compact16<'  '/17$'  'BM_Erase.*<SBO16<std::string>>'
+// (operations copying elements skip MoveOnly)
+// Every container allocates through BenchmarkCountingAllocator, each result carries per
+// iteration allocs, frees, bytes_allocated and the peak_bytes live (see ScopedAllocationCounters),
+// container buffers only (not what std::string or NonTrivial elements allocate themselves)
+// Insert, push_back, erase and pop_back time batches of containers (see RunBatched): an
+// iteration is a batch, compare their items_per_second; their allocs stay per container,
+// the untimed filling of each batch left out
+// With SBOVECTOR_BENCHMARK_PERF=1 (Linux) hardware counters are added per element (per container
+// for the unsized benchmarks), instruction and branch miss counts being far steadier than time
+
+struct Pod64 {
+  int64_t values_[8];
+};
+static_assert(sizeof(Pod64) == 64 && std::is_trivial_v<Pod64>);
+
+template <typename T>
+using Std = std::vector<T, BenchmarkCountingAllocator<T>>;
+template <typename T>
+using SBO16 = SBOVector<T, 16, BenchmarkCountingAllocator<T>>;
+template <typename T>
+using Compact16 = CompactSBOVector<T, 16, BenchmarkCountingAllocator<T>>;
+
+template <typename ContainerType>
+using ValueType = std::remove_reference_t<decltype(std::declval<ContainerType>().at(0))>;
+
+template <typename DataType>
+DataType CreateValue() {
+  if constexpr (std::is_arithmetic_v<DataType>) {
+    return DataType(42);
+  } else if constexpr (std::is_same_v<DataType, Pod64>) {
+    return Pod64{{42, 0, 0, 0, 0, 0, 0, 0}};
+  } else if constexpr (std::is_same_v<DataType, std::string>) {
+    // beyond the small string optimization
+    return std::string(32, 'x');
+  } else {
+    return DataType();
+  }
+}
+
 template<typename ContainerType>
 auto CreateValueForContainer() {
-  std::remove_reference_t<decltype(std::declval<ContainerType>().at(0))> out(42);
-  return out;
+  return CreateValue<ValueType<ContainerType>>();
+}
+
+template <typename ContainerType>
+constexpr bool kCopyable = std::is_copy_constructible_v<ValueType<ContainerType>>;
+
+// count elements, copies of CreateValueForContainer() if copyable
+template <typename ContainerType>
+ContainerType CreateFilled(size_t count) {
+  if constexpr (kCopyable<ContainerType>) {
+    return ContainerType(count, CreateValueForContainer<ContainerType>());
+  } else {
+    return ContainerType(count);
+  }
+}
+
+// reads every element
+template <typename ContainerType>
+void Consume(const ContainerType& container) {
+  using DataType = ValueType<ContainerType>;
+  if constexpr (std::is_arithmetic_v<DataType>) {
+    auto total = std::accumulate(container.begin(), container.end(), DataType(0));
+    benchmark::DoNotOptimize(total);
+  } else if constexpr (std::is_same_v<DataType, Pod64>) {
+    int64_t total = 0;
+    for (const auto& element : container) {
+      total += element.values_[0];
+    }
+    benchmark::DoNotOptimize(total);
+  } else if constexpr (std::is_same_v<DataType, std::string>) {
+    size_t total = 0;
+    for (const auto& element : container) {
+      total += element.size();
+    }
+    benchmark::DoNotOptimize(total);
+  } else {
+    for (const auto& element : container) {
+      benchmark::DoNotOptimize(element);
+    }
+  }
 }
 
 template<typename ContainerType>
 void BM_DefaultConstruct(benchmark::State& state) {
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     ContainerType container;
     benchmark::DoNotOptimize(container);
   }
+  perf_counters.Report(state, 1);
+  allocation_counters.Report(state);
 }
 
 template<typename ContainerType>
 void BM_CountConsturct(benchmark::State& state) {
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     const auto count = static_cast<size_t>(state.range(0));
     ContainerType container(count);
   }
+  perf_counters.Report(state, state.range(0));
+  allocation_counters.Report(state);
 }
 
 template<typename ContainerType>
 void BM_CountValueConstructor(benchmark::State& state) {
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     const auto count = static_cast<size_t>(state.range(0));
     const auto value = CreateValueForContainer<ContainerType>();
     ContainerType container(count, value);
   }
+  perf_counters.Report(state, state.range(0));
+  allocation_counters.Report(state);
 }
 
 template<typename ContainerType>
@@ -49,13 +152,17 @@ void BM_RangeConstructor(benchmark::State& state) {
   using DataType = std::remove_reference_t<decltype(std::declval<ContainerType>().at(0))>;
   std::vector<DataType> vec;
   vec.reserve(static_cast<size_t>(state.range(0)));
-  for (auto i = 0u; i < state.range(0); ++i) {
+  for (auto i = 0; i < state.range(0); ++i) {
     vec.push_back(CreateValueForContainer<ContainerType>());
   }
 
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     ContainerType container(vec.begin(), vec.end());
   }
+  perf_counters.Report(state, state.range(0));
+  allocation_counters.Report(state);
 }
 
 template<typename ContainerType>
@@ -63,9 +170,13 @@ void BM_CopyConstructor(benchmark::State& state) {
   const auto count = static_cast<size_t>(state.range(0));
   const auto value = CreateValueForContainer<ContainerType>();
   const ContainerType original(count, value);
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     ContainerType copy(original);
   }
+  perf_counters.Report(state, state.range(0));
+  allocation_counters.Report(state);
 }
 
 template<typename ContainerType>
@@ -74,13 +185,16 @@ void BM_MoveConstructor(benchmark::State& state) {
       container_space;
   auto poriginal = reinterpret_cast<ContainerType*>(&container_space);
   const auto count = static_cast<size_t>(state.range(0));
-  const auto value = CreateValueForContainer<ContainerType>();
-  new(poriginal) ContainerType(count, value);
+  new(poriginal) ContainerType(CreateFilled<ContainerType>(count));
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     ContainerType temp(std::move(*poriginal));
     std::destroy_at(poriginal);
     new (poriginal) ContainerType(std::move(temp));
   }
+  perf_counters.Report(state, state.range(0));
+  allocation_counters.Report(state);
   std::destroy_at(poriginal);
 }
 
@@ -89,30 +203,42 @@ void BM_AssignOperatorCopy(benchmark::State& state) {
   const auto count = static_cast<size_t>(state.range(0));
   const auto value = CreateValueForContainer<ContainerType>();
   ContainerType a(count, value), b;
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     b = a;
     a = b;
   }
+  perf_counters.Report(state, state.range(0));
+  allocation_counters.Report(state);
 }
 
 template <typename ContainerType>
 void BM_AssignOperatorMove(benchmark::State& state) {
   const auto count = static_cast<size_t>(state.range(0));
-  const auto value = CreateValueForContainer<ContainerType>();
-  ContainerType a(count, value), b;
+  auto a = CreateFilled<ContainerType>(count);
+  ContainerType b;
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     b = std::move(a);
     a = std::move(b);
   }
+  perf_counters.Report(state, state.range(0));
+  allocation_counters.Report(state);
 }
 template <typename ContainerType>
 void BM_AssignCountValue(benchmark::State& state) {
   const auto count = static_cast<size_t>(state.range(0));
   const auto value = CreateValueForContainer<ContainerType>();
   ContainerType a(count, value);
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     a.assign(count, value);
   }
+  perf_counters.Report(state, state.range(0));
+  allocation_counters.Report(state);
 }
 
 template <typename ContainerType>
@@ -121,34 +247,103 @@ void BM_AssignRange(benchmark::State& state) {
   const auto value = CreateValueForContainer<ContainerType>();
   std::vector vec(count, value);
   ContainerType c;
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     c.assign(vec.begin(), vec.end());
   }
+  perf_counters.Report(state, state.range(0));
+  allocation_counters.Report(state);
 }
 
 template<typename ContainerType>
 void BM_Iterate(benchmark::State& state) {
   const auto count = static_cast<size_t>(state.range(0));
-  const auto value = CreateValueForContainer<ContainerType>();
-  ContainerType a(count, value);
+  const auto a = CreateFilled<ContainerType>(count);
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
-    auto total = std::accumulate(a.begin(), a.end(), value);
-    benchmark::DoNotOptimize(total);
+    Consume(a);
   }
+  perf_counters.Report(state, state.range(0));
+  allocation_counters.Report(state);
 }
 
 template<typename ContainerType>
 void BM_SequentialIteration(benchmark::State& state) {
   std::array<ContainerType, 1000> containers;
-  const auto value = CreateValueForContainer<ContainerType>();
   for (size_t i = 0u; i < containers.size(); ++i) {
-    containers[i].assign((i % 997) ? (i % 2 ? 8 : 16) : 500, value);
+    containers[i] = CreateFilled<ContainerType>((i % 997) ? (i % 2 ? 8 : 16) : 500);
   }
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     for (auto& container : containers) {
-      auto total = std::accumulate(container.begin(), container.end(), value);
-      benchmark::DoNotOptimize(total);
+      Consume(container);
+    }
+  }
+  perf_counters.Report(state, static_cast<int64_t>(containers.size()));
+  allocation_counters.Report(state);
+}
+
+// Batched timing for operations on fresh containers: every iteration builds a batch of
+// containers untimed, times the operation across all of them, and destroys them untimed at
+// the start of the next iteration (one PauseTiming / ResumeTiming pair per batch, not per
+// container). Batches hold about 32K elements (8 to 4096 containers), so the time per
+// iteration is per batch: compare items_per_second (elements), allocation counters are per
+// container. timing_overhead self checks the result: the time spent in PauseTiming and
+// ResumeTiming over the time measured (part of it leaks into the measurement, past a few %
+// the result is mostly timer).
+inline int64_t BatchSize(size_t count) {
+  constexpr size_t kBatchElements = 1 << 15;
+  return static_cast<int64_t>(
+      std::clamp<size_t>(kBatchElements / std::max<size_t>(count, 1), 8, 4096));
+}
+
+template <typename ContainerType, typename Make, typename Operate>
+void RunBatched(benchmark::State& state, Make&& make, Operate&& operate) {
+  using Clock = std::chrono::steady_clock;
+  const auto count = static_cast<size_t>(state.range(0));
+  const auto batch_size = BatchSize(count);
+  std::vector<ContainerType> batch;
+  batch.reserve(static_cast<size_t>(batch_size));
+  Clock::duration measured{};
+  Clock::duration timer{};
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
+  auto timed_from = Clock::now();
+  for (auto _ : state) {
+    const auto pause = Clock::now();
+    measured += pause - timed_from;
+    state.PauseTiming();
+    const auto paused = Clock::now();
+    perf_counters.Pause();
+    allocation_counters.Pause();
+    batch.clear();
+    for (int64_t i = 0; i < batch_size; ++i) {
+      batch.push_back(make());
     }
+    allocation_counters.Resume();
+    perf_counters.Resume();
+    const auto resume = Clock::now();
+    state.ResumeTiming();
+    timed_from = Clock::now();
+    timer += (paused - pause) + (timed_from - resume);
+    for (auto& c : batch) {
+      operate(c);
+    }
+  }
+  measured += Clock::now() - timed_from;
+  perf_counters.Pause();
+  allocation_counters.Pause();
+  batch.clear();
+  perf_counters.Report(state, batch_size * state.range(0));
+  allocation_counters.Report(state, batch_size);
+  state.SetItemsProcessed(state.iterations() * batch_size * state.range(0));
+  state.counters["batch"] = static_cast<double>(batch_size);
+  if (measured.count() > 0) {
+    using Seconds = std::chrono::duration<double>;
+    state.counters["timing_overhead"] = Seconds(timer).count() / Seconds(measured).count();
   }
 }
 
@@ -156,120 +351,89 @@ template<typename ContainerType>
 void BM_InsertSingle(benchmark::State& state) {
   const auto count = static_cast<size_t>(state.range(0));
   const auto value = CreateValueForContainer<ContainerType>();
-  for (auto _ : state) {
-    state.PauseTiming();
-    { 
-      ContainerType c;
-      state.ResumeTiming();
-      for (auto i = 0u; i < count; ++i) {
+  RunBatched<ContainerType>(state, []() { return ContainerType(); }, [&](ContainerType& c) {
+    for (auto i = 0u; i < count; ++i) {
+      if constexpr (kCopyable<ContainerType>) {
         c.insert(c.begin(), value);
+      } else {
+        c.emplace(c.begin());
       }
-      state.PauseTiming();
     }
-    state.ResumeTiming();
-  
-  }
+  });
 }
 
 template <typename ContainerType>
 void BM_InsertCount(benchmark::State& state) {
   const auto count = static_cast<size_t>(state.range(0));
   const auto value = CreateValueForContainer<ContainerType>();
-  for (auto _ : state) {
-    state.PauseTiming();
-    {
-      ContainerType c;
-      state.ResumeTiming();
-      for (auto i = 0u; i < count; ++i) {
-        c.insert(c.begin(), 5, value);
-      }
-      state.PauseTiming();
+  RunBatched<ContainerType>(state, []() { return ContainerType(); }, [&](ContainerType& c) {
+    for (auto i = 0u; i < count; ++i) {
+      c.insert(c.begin(), 5, value);
     }
-    state.ResumeTiming();
-  }
+  });
 }
 
 template <typename ContainerType>
 void BM_PushBack(benchmark::State& state) {
   const auto count = static_cast<size_t>(state.range(0));
   const auto value = CreateValueForContainer<ContainerType>();
-  for (auto _ : state) {
-    state.PauseTiming();
-    {
-      ContainerType c;
-      state.ResumeTiming();
-      for (auto i = 0u; i < count; ++i) {
+  RunBatched<ContainerType>(state, []() { return ContainerType(); }, [&](ContainerType& c) {
+    for (auto i = 0u; i < count; ++i) {
+      if constexpr (kCopyable<ContainerType>) {
         c.push_back(value);
+      } else {
+        c.emplace_back();
       }
-      state.PauseTiming();
     }
-    state.ResumeTiming();
-  }
+  });
 }
 
 template <typename ContainerType>
 void BM_EraseSingle(benchmark::State& state) {
   const auto count = static_cast<size_t>(state.range(0));
-  const auto value = CreateValueForContainer<ContainerType>();
-  for (auto _ : state) {
-    state.PauseTiming();
-    {
-      ContainerType c(count, value);
-      state.ResumeTiming();
-      for (auto i = 0u; i < count; ++i) {
-        c.erase(c.begin());
-      }
-      state.PauseTiming();
-    }
-    state.ResumeTiming();
-  }
+  RunBatched<ContainerType>(
+      state, [count]() { return CreateFilled<ContainerType>(count); }, [count](ContainerType& c) {
+        for (auto i = 0u; i < count; ++i) {
+          c.erase(c.begin());
+        }
+      });
 }
 
 template <typename ContainerType>
 void BM_EraseCount(benchmark::State& state) {
   const auto count = static_cast<size_t>(state.range(0));
-  const auto value = CreateValueForContainer<ContainerType>();
-  for (auto _ : state) {
-    state.PauseTiming();
-    {
-      ContainerType c(count, value);
-      state.ResumeTiming();
-      for (auto i = 0u; (i + 6) < count; i += 6) {
-        c.erase(c.begin(), c.begin() + 6);
-      }
-      state.PauseTiming();
-    }
-    state.ResumeTiming();
-  }
+  RunBatched<ContainerType>(
+      state, [count]() { return CreateFilled<ContainerType>(count); }, [count](ContainerType& c) {
+        for (auto i = 0u; (i + 6) < count; i += 6) {
+          c.erase(c.begin(), c.begin() + 6);
+        }
+      });
 }
 
 template <typename ContainerType>
 void BM_PopBack(benchmark::State& state) {
   const auto count = static_cast<size_t>(state.range(0));
-  const auto value = CreateValueForContainer<ContainerType>();
-  for (auto _ : state) {
-    state.PauseTiming();
-    {
-      ContainerType c(count, value);
-      state.ResumeTiming();
-      for (auto i = 0u; i < count; ++i) {
-        c.pop_back();
-      }
-      state.PauseTiming();
-    }
-    state.ResumeTiming();
-  }
+  RunBatched<ContainerType>(
+      state, [count]() { return CreateFilled<ContainerType>(count); }, [count](ContainerType& c) {
+        for (auto i = 0u; i < count; ++i) {
+          c.pop_back();
+        }
+      });
 }
 
 template<typename ContainerType>
 void BM_Resize(benchmark::State& state) {
   ContainerType c;
   const auto count = static_cast<size_t>(state.range(0)) + 10;
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     for (auto i = 10u; i < count; ++i) {
       c.resize(i % 2 ? i : i / 2);
     }
   }
+  perf_counters.Report(state, state.range(0));
+  allocation_counters.Report(state);
 }
 
 template<typename ContainerType>
@@ -278,61 +442,69 @@ void BM_Swap(benchmark::State& state) {
   const auto count_b = static_cast<size_t>(state.range(1));
   ContainerType a(count_a);
   ContainerType b(count_b);
+  ScopedAllocationCounters allocation_counters(state);
+  ScopedPerfCounters perf_counters;
   for (auto _ : state) {
     a.swap(b);
   }
+  perf_counters.Report(state, 1);
+  allocation_counters.Report(state);
 }
 
-#define BM_TEMPLATE(NAME, TYPE) BENCHMARK_TEMPLATE(NAME, TYPE)
-
-#define BM_TEMPLATER(NAME, TYPE, LOW, HIGH) \
-  BENCHMARK_TEMPLATE(NAME, TYPE)->Range(LOW, HIGH)
-
-#define BM_TEMPLATERM(NAME, TYPE, MUL, LOW, HIGH) \
-  BENCHMARK_TEMPLATE(NAME,TYPE)->RangeMultiplier(MUL)->Range(LOW, HIGH)
-
-#define CONSTRUCTOR_BENCHMARKS(TYPE) \
-  BM_TEMPLATE(BM_DefaultConstruct, TYPE); \
-  BM_TEMPLATERM(BM_CountConsturct, TYPE, 2, 8, 64); \
-  BM_TEMPLATERM(BM_CountValueConstructor, TYPE, 2, 8, 64); \
-  BM_TEMPLATERM(BM_RangeConstructor, TYPE, 2, 8, 64);\
-  BM_TEMPLATERM(BM_CopyConstructor, TYPE, 2, 8, 64);\
-  BM_TEMPLATERM(BM_MoveConstructor, TYPE, 2, 8, 64)
-
-#define ASSIGNMENT_BENCHMARKS(TYPE) \
-  BM_TEMPLATERM(BM_AssignOperatorCopy, TYPE, 2, 8, 64);\
-  BM_TEMPLATERM(BM_AssignOperatorMove, TYPE, 2, 8, 64);\
-  BM_TEMPLATERM(BM_AssignCountValue, TYPE, 2, 8, 64); \
-  BM_TEMPLATERM(BM_AssignRange, TYPE, 2, 8, 64)
-
-#define ITERATION_BENCHMARKS(TYPE) \
-  BM_TEMPLATERM(BM_Iterate, TYPE, 2, 8, 64); \
-  BM_TEMPLATE(BM_SequentialIteration, TYPE)
-
-#define MODIFY_BENCHMARKS(TYPE) \
-  BM_TEMPLATERM(BM_InsertSingle, TYPE, 2, 8, 32);\
-  BM_TEMPLATERM(BM_InsertCount, TYPE, 2, 8, 32);\
-  BM_TEMPLATERM(BM_PushBack, TYPE, 2, 8, 32);\
-  BM_TEMPLATERM(BM_EraseSingle, TYPE, 2, 8, 32); \
-  BM_TEMPLATERM(BM_EraseCount, TYPE, 2, 8, 32); \
-  BM_TEMPLATERM(BM_PopBack, TYPE, 2, 8, 32);\
-  BM_TEMPLATERM(BM_Resize, TYPE, 2, 8, 32)
-
-#define SWAP_BENCHMARKS(TYPE)\
-  BM_TEMPLATE(BM_Swap, TYPE)->Args({8, 16})->Args({16, 32})->Args({32, 32})
-
-#define TEMPLATE_ALL_BENCHMARKS(TYPE) \
-  CONSTRUCTOR_BENCHMARKS(TYPE); \
-  ASSIGNMENT_BENCHMARKS(TYPE); \
-  ITERATION_BENCHMARKS(TYPE); \
-  MODIFY_BENCHMARKS(TYPE); \
-  SWAP_BENCHMARKS(TYPE)
-
-typedef SBOVector<int, 16> SBOVectorInt16;
-typedef SBOVector<int, 16, std::allocator<int>, true> CompactSBOVectorInt16;
-
-ITERATION_BENCHMARKS(std::vector<int>);
-ITERATION_BENCHMARKS(SBOVectorInt16);
-ITERATION_BENCHMARKS(CompactSBOVectorInt16);
-
-BENCHMARK_MAIN();
\ No newline at end of file
+// sizes: inline, full inline, crossing BufferSize (16), spilled
+#define MATRIX_SIZES ->Arg(8)->Arg(16)->Arg(17)->Arg(64)->Arg(256)
+#define MATRIX_SWAP_SIZES ->Args({8, 16})->Args({8, 64})->Args({64, 256})
+#define MATRIX_NO_SIZES
+
+#define CONTAINER_BENCHMARKS(NAME, ELEMENT, SIZES) \
+  BENCHMARK_TEMPLATE(NAME, Std<ELEMENT>) SIZES; \
+  BENCHMARK_TEMPLATE(NAME, SBO16<ELEMENT>) SIZES; \
+  BENCHMARK_TEMPLATE(NAME, Compact16<ELEMENT>) SIZES
+
+#define COPYABLE_BENCHMARKS(NAME, SIZES) \
+  CONTAINER_BENCHMARKS(NAME, int, SIZES); \
+  CONTAINER_BENCHMARKS(NAME, Pod64, SIZES); \
+  CONTAINER_BENCHMARKS(NAME, std::string, SIZES); \
+  CONTAINER_BENCHMARKS(NAME, NonTrivial, SIZES)
+
+#define ALL_ELEMENT_BENCHMARKS(NAME, SIZES) \
+  COPYABLE_BENCHMARKS(NAME, SIZES); \
+  CONTAINER_BENCHMARKS(NAME, MoveOnly, SIZES)
+
+#define CONSTRUCTOR_BENCHMARKS \
+  ALL_ELEMENT_BENCHMARKS(BM_DefaultConstruct, MATRIX_NO_SIZES); \
+  ALL_ELEMENT_BENCHMARKS(BM_CountConsturct, MATRIX_SIZES); \
+  COPYABLE_BENCHMARKS(BM_CountValueConstructor, MATRIX_SIZES); \
+  COPYABLE_BENCHMARKS(BM_RangeConstructor, MATRIX_SIZES); \
+  COPYABLE_BENCHMARKS(BM_CopyConstructor, MATRIX_SIZES); \
+  ALL_ELEMENT_BENCHMARKS(BM_MoveConstructor, MATRIX_SIZES)
+
+#define ASSIGNMENT_BENCHMARKS \
+  COPYABLE_BENCHMARKS(BM_AssignOperatorCopy, MATRIX_SIZES); \
+  ALL_ELEMENT_BENCHMARKS(BM_AssignOperatorMove, MATRIX_SIZES); \
+  COPYABLE_BENCHMARKS(BM_AssignCountValue, MATRIX_SIZES); \
+  COPYABLE_BENCHMARKS(BM_AssignRange, MATRIX_SIZES)
+
+#define ITERATION_BENCHMARKS \
+  ALL_ELEMENT_BENCHMARKS(BM_Iterate, MATRIX_SIZES); \
+  ALL_ELEMENT_BENCHMARKS(BM_SequentialIteration, MATRIX_NO_SIZES)
+
+#define MODIFY_BENCHMARKS \
+  ALL_ELEMENT_BENCHMARKS(BM_InsertSingle, MATRIX_SIZES); \
+  COPYABLE_BENCHMARKS(BM_InsertCount, MATRIX_SIZES); \
+  ALL_ELEMENT_BENCHMARKS(BM_PushBack, MATRIX_SIZES); \
+  ALL_ELEMENT_BENCHMARKS(BM_EraseSingle, MATRIX_SIZES); \
+  ALL_ELEMENT_BENCHMARKS(BM_EraseCount, MATRIX_SIZES); \
+  ALL_ELEMENT_BENCHMARKS(BM_PopBack, MATRIX_SIZES); \
+  ALL_ELEMENT_BENCHMARKS(BM_Resize, MATRIX_SIZES)
+
+#define SWAP_BENCHMARKS \
+  ALL_ELEMENT_BENCHMARKS(BM_Swap, MATRIX_SWAP_SIZES)
+
+CONSTRUCTOR_BENCHMARKS;
+ASSIGNMENT_BENCHMARKS;
+ITERATION_BENCHMARKS;
+MODIFY_BENCHMARKS;
+SWAP_BENCHMARKS;
+
+BENCHMARK_MAIN();
@@ -0,0 +1,113 @@
+#include "benchmark_common.hpp"
+
+#include "sbovector.hpp"
+#include "sbovector_compaction.hpp"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// A long lived collection of 1M SBOVector<int, 8> (30% spill, 9 to 64 elements) built by
+// push_back, interleaved with other short lived allocations, before and after compact_collection
+// Iterate: sum of every element, Compact: compaction time, RSS of the built and compacted
+// collection ("built_rss_MB", "compacted_rss_MB", after returning free heap pages when possible)
+
+namespace {
+
+constexpr size_t kVectors = 1 << 20;
+constexpr size_t kInline = 8;
+
+using Vector = SBOVector<int, kInline, CompactingAllocator<int>>;
+
+struct Collection {
+  // (declared first: outlives the vectors)
+  CompactionState state_;
+  std::vector<Vector> vectors_;
+};
+
+std::unique_ptr<Collection> Build() {
+  std::mt19937 random(42);
+  auto out = std::make_unique<Collection>();
+  out->vectors_.reserve(kVectors);
+  // freed at the end, leaving holes between the spill buffers
+  std::vector<std::unique_ptr<char[]>> transient;
+  for (size_t i = 0; i < kVectors; ++i) {
+    const auto size = random() % 10 < 3 ? kInline + 1 + random() % 56 : random() % (kInline + 1);
+    out->vectors_.emplace_back(CompactingAllocator<int>(out->state_));
+    for (size_t j = 0; j < size; ++j) {
+      out->vectors_.back().push_back(static_cast<int>(j));
+      if (j == kInline) {
+        transient.emplace_back(new char[48]);
+      }
+    }
+  }
+  return out;
+}
+
+void ReturnFreeHeapPages() {
+#if defined(__GLIBC__)
+  malloc_trim(0);
+#endif
+}
+
+double MB(size_t after, size_t before) {
+  return after > before ? static_cast<double>(after - before) / (1024.0 * 1024.0) : 0.0;
+}
+
+void RunIterate(benchmark::State& state, const Collection& collection) {
+  for (auto _ : state) {
+    long long sum = 0;
+    for (const auto& vector : collection.vectors_) {
+      for (auto value : vector) {
+        sum += value;
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kVectors));
+}
+
+}  // namespace
+
+static void BM_CompactionIterateScattered(benchmark::State& state) {
+  static const auto collection = Build();
+  RunIterate(state, *collection);
+}
+
+static void BM_CompactionIterateCompacted(benchmark::State& state) {
+  static const auto collection = []() {
+    auto out = Build();
+    compact_collection(out->vectors_);
+    return out;
+  }();
+  RunIterate(state, *collection);
+}
+
+static void BM_CompactCollection(benchmark::State& state) {
+  for (auto _ : state) {
+    state.PauseTiming();
+    ReturnFreeHeapPages();
+    const auto baseline = rss::CurrentBytes();
+    auto collection = Build();
+    ReturnFreeHeapPages();
+    state.counters["built_rss_MB"] = MB(rss::CurrentBytes(), baseline);
+    state.ResumeTiming();
+
+    compact_collection(collection->vectors_);
+
+    state.PauseTiming();
+    ReturnFreeHeapPages();
+    state.counters["compacted_rss_MB"] = MB(rss::CurrentBytes(), baseline);
+    collection.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kVectors));
+}
+
+BENCHMARK(BM_CompactionIterateScattered)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CompactionIterateCompacted)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_CompactCollection)->Unit(benchmark::kMillisecond)->Iterations(3);
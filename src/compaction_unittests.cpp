@@ -0,0 +1,107 @@
+#include "unittest_common.hpp"
+
+#include "sbovector_compaction.hpp"
+
+// Unittests for compact_collection/CompactingAllocator
+
+namespace {
+
+template <typename DataType>
+using CompactingVector = SBOVector<DataType, SMALL_SIZE, CompactingAllocator<DataType>>;
+
+// a pointer, no shared ownership to copy around
+static_assert(sizeof(CompactingAllocator<int>) == sizeof(CompactionState*));
+
+}  // namespace
+
+TEST(ValueVerifiedCompaction, MustRelocateSpilledVectorsIntoOneSlab) {
+  CompactionState state;
+  std::vector<CompactingVector<int>> vectors;
+  size_t spilled_elements = 0;
+  for (auto i = 0u; i < LARGE_SIZE; ++i) {
+    vectors.emplace_back(CompactingAllocator<int>(state));
+    for (auto j = 0u; j < i; ++j) {
+      vectors.back().push_back(static_cast<int>(i + j));
+    }
+    spilled_elements += i > SMALL_SIZE ? i : 0;
+  }
+
+  EXPECT_EQ(compact_collection(vectors), spilled_elements * sizeof(int));
+  EXPECT_EQ(state.slab_count(), 1u);
+
+  const int* next = nullptr;
+  for (auto i = 0u; i < vectors.size(); ++i) {
+    ASSERT_EQ(vectors[i].size(), i);
+    for (auto j = 0u; j < i; ++j) {
+      ASSERT_EQ(vectors[i][j], static_cast<int>(i + j));
+    }
+    if (i > SMALL_SIZE) {
+      // exact capacity, back to back in collection order
+      EXPECT_EQ(vectors[i].capacity(), i);
+      if (next) {
+        EXPECT_EQ(vectors[i].data(), next);
+      }
+      next = vectors[i].data() + i;
+    }
+  }
+
+  // leaving the slab (growth, shrinking back inline) releases it
+  for (auto i = SMALL_SIZE + 1; i < vectors.size(); i += 2) {
+    vectors[i].push_back(0);
+    vectors[i + 1].erase(vectors[i + 1].begin() + SMALL_SIZE, vectors[i + 1].end());
+  }
+  EXPECT_EQ(state.slab_count(), 0u);
+}
+
+TEST(ValueVerifiedCompaction, MustCompactAgainIntoANewSlab) {
+  CompactionState state;
+  std::vector<CompactingVector<int>> vectors(SMALL_SIZE, CompactingVector<int>(CompactingAllocator<int>(state)));
+  for (auto& vector : vectors) {
+    vector.assign(LARGE_SIZE, 1);
+  }
+  compact_collection(vectors);
+  EXPECT_EQ(state.slab_count(), 1u);
+
+  vectors.front().push_back(2);
+  EXPECT_EQ(compact_collection(vectors), (SMALL_SIZE * LARGE_SIZE + 1) * sizeof(int));
+  // every buffer of the first slab was released
+  EXPECT_EQ(state.slab_count(), 1u);
+  EXPECT_EQ(vectors.front().back(), 2);
+  EXPECT_EQ(vectors.front().capacity(), LARGE_SIZE + 1);
+
+  vectors.clear();
+  EXPECT_EQ(state.slab_count(), 0u);
+}
+
+TEST(ValueVerifiedCompaction, MustSkipVectorsOfOtherStates) {
+  CompactionState other;
+  std::vector<CompactingVector<int>> vectors;
+  vectors.emplace_back();
+  vectors.emplace_back(CompactingAllocator<int>(other));
+  for (auto& vector : vectors) {
+    vector.assign(LARGE_SIZE, 1);
+  }
+  // default allocators share no state
+  EXPECT_EQ(compact_collection(vectors), 0u);
+  EXPECT_EQ(vectors[1].get_allocator().state_->slab_count(), 0u);
+}
+
+TEST_F(DataTypeOperationTrackingSBOVector, MustMoveElementsWhenCompacting) {
+  CompactionState state;
+  {
+    std::vector<CompactingVector<DataType>> vectors;
+    for (auto i = 0u; i < SMALL_SIZE; ++i) {
+      vectors.emplace_back(CompactingAllocator<DataType>(state));
+      for (auto j = 0u; j < LARGE_SIZE; ++j) {
+        vectors.back().emplace_back();
+      }
+    }
+    compact_collection(vectors);
+    for (auto& vector : vectors) {
+      UseElements(vector);
+    }
+    EXPECT_EQ(state.slab_count(), 1u);
+  }
+  EXPECT_EQ(state.slab_count(), 0u);
+  EXPECT_EQ(OperationCounter::TOTALS.copies(), 0);
+}
@@ -0,0 +1,177 @@
+#include "unittest_common.hpp"
+
+#include <list>
+
+// Unittests for complexity guarantees: upper bounds on element copies/moves and allocations,
+// so a change doing more work per operation fails here rather than hiding in benchmark noise
+
+namespace {
+
+struct OperationSnapshot {
+  int copies_;
+  int moves_;
+  int allocs_;
+  int frees_;
+};
+
+}  // namespace
+
+struct DataTypeOperationTrackingComplexitySBOVector : public DataTypeOperationTrackingSBOVector {
+  OperationSnapshot Snapshot() const {
+    const auto& op_totals = OperationCounter::TOTALS;
+    return {op_totals.copies(), op_totals.moves(), totals_.allocs_, totals_.frees_};
+  }
+
+  // operations since before
+  OperationSnapshot Since(const OperationSnapshot& before) const {
+    const auto now = Snapshot();
+    return {now.copies_ - before.copies_, now.moves_ - before.moves_, now.allocs_ - before.allocs_,
+            now.frees_ - before.frees_};
+  }
+};
+
+TEST_F(DataTypeOperationTrackingComplexitySBOVector, MustPushBackInAmortizedConstantMoves) {
+  constexpr int kInserts = 1000000;
+  ContainerType container(create_allocator());
+  const auto before = Snapshot();
+  for (auto i = 0; i < kInserts; ++i) {
+    container.push_back(DataType());
+  }
+  const auto pushed = Since(before);
+  EXPECT_EQ(pushed.copies_, 0);
+  // one move of the temporary each, plus relocations on growth: geometric, under 2 per element
+  EXPECT_LE(pushed.moves_, 3 * kInserts);
+  // one allocation per doubling past the inline buffer
+  EXPECT_LE(pushed.allocs_, 17);
+  EXPECT_EQ(pushed.allocs_, pushed.frees_ + 1);
+}
+
+TEST_F(DataTypeOperationTrackingComplexitySBOVector, MustCopyPushBackOnce) {
+  constexpr int kInserts = 1000000;
+  ContainerType container(create_allocator());
+  const DataType value;
+  const auto before = Snapshot();
+  for (auto i = 0; i < kInserts; ++i) {
+    container.push_back(value);
+  }
+  const auto pushed = Since(before);
+  EXPECT_EQ(pushed.copies_, kInserts);
+  EXPECT_LE(pushed.moves_, 2 * kInserts);
+}
+
+TEST_F(DataTypeOperationTrackingComplexitySBOVector, MustNotCopyOnMoveConstruction) {
+  {  // inline: elements move one by one
+    ContainerType from(SMALL_SIZE, create_allocator());
+    const auto before = Snapshot();
+    ContainerType to(std::move(from));
+    const auto moved = Since(before);
+    EXPECT_EQ(moved.copies_, 0);
+    EXPECT_LE(moved.moves_, static_cast<int>(SMALL_SIZE));
+    EXPECT_EQ(moved.allocs_, 0);
+    UseElements(to);
+  }
+  {  // external: the buffer is taken
+    ContainerType from(LARGE_SIZE, create_allocator());
+    const auto before = Snapshot();
+    ContainerType to(std::move(from));
+    const auto moved = Since(before);
+    EXPECT_EQ(moved.copies_, 0);
+    EXPECT_EQ(moved.moves_, 0);
+    EXPECT_EQ(moved.allocs_, 0);
+    UseElements(to);
+  }
+}
+
+TEST_F(DataTypeOperationTrackingComplexitySBOVector, MustNotMoveOnCompactMoveConstruction) {
+  using CompactContainerType = CompactSBOVector<DataType, SBO_SIZE, AllocatorType>;
+  CompactContainerType from(LARGE_SIZE, create_allocator());
+  const auto before = Snapshot();
+  CompactContainerType to(std::move(from));
+  const auto moved = Since(before);
+  EXPECT_EQ(moved.copies_, 0);
+  EXPECT_EQ(moved.moves_, 0);
+  EXPECT_EQ(moved.allocs_, 0);
+  EXPECT_TRUE(from.empty());
+  EXPECT_EQ(to.size(), LARGE_SIZE);
+  UseElements(to);
+}
+
+TEST_F(DataTypeOperationTrackingComplexitySBOVector, MustNotCopyOnMoveAssignment) {
+  for (auto from_size : {SMALL_SIZE, LARGE_SIZE}) {
+    for (auto to_size : {SMALL_SIZE, LARGE_SIZE}) {
+      ContainerType from(from_size, create_allocator());
+      ContainerType to(to_size, create_allocator());
+      const auto before = Snapshot();
+      to = std::move(from);
+      const auto moved = Since(before);
+      // (move assignment swaps) inline elements are exchanged, spilled ones never move
+      const auto inline_elements = (from_size > SBO_SIZE ? 0 : from_size) +
+                                   (to_size > SBO_SIZE ? 0 : to_size);
+      EXPECT_EQ(moved.copies_, 0);
+      EXPECT_LE(moved.moves_, 3 * static_cast<int>(inline_elements));
+      EXPECT_EQ(moved.allocs_, 0);
+      UseElements(to);
+    }
+  }
+}
+
+TEST_F(DataTypeOperationTrackingComplexitySBOVector, MustMoveAtMostSizeOnInsert) {
+  for (auto size : {SMALL_SIZE, LARGE_SIZE}) {
+    for (size_t position = 0; position <= size; ++position) {
+      ContainerType container(size, create_allocator());
+      const DataType value;
+      const auto before = Snapshot();
+      container.insert(container.begin() + static_cast<ptrdiff_t>(position), value);
+      const auto inserted = Since(before);
+      EXPECT_EQ(inserted.copies_, 1);
+      // relocating every element when growing, only the tail otherwise
+      const auto grew = inserted.allocs_ > 0;
+      EXPECT_LE(inserted.moves_, static_cast<int>(grew ? size : size - position));
+      EXPECT_LE(inserted.allocs_, 1);
+      UseElements(container);
+    }
+  }
+}
+
+TEST_F(DataTypeOperationTrackingComplexitySBOVector, MustAllocateOnceForForwardRangeConstruction) {
+  for (auto size : {SMALL_SIZE, SBO_SIZE + 1, LARGE_SIZE}) {
+    const std::list<DataType> source(size);
+    const auto before = Snapshot();
+    ContainerType container(source.begin(), source.end(), create_allocator());
+    const auto constructed = Since(before);
+    EXPECT_EQ(constructed.copies_, static_cast<int>(size));
+    EXPECT_EQ(constructed.moves_, 0);
+    EXPECT_EQ(constructed.allocs_, size > SBO_SIZE ? 1 : 0);
+    UseElements(container);
+  }
+}
+
+TEST_F(DataTypeOperationTrackingComplexitySBOVector, MustNotAllocateForInlineSwap) {
+  ContainerType a(SMALL_SIZE, create_allocator());
+  ContainerType b(SBO_SIZE, create_allocator());
+  const auto before = Snapshot();
+  a.swap(b);
+  const auto swapped = Since(before);
+  EXPECT_EQ(swapped.copies_, 0);
+  // a three move exchange per element at most
+  EXPECT_LE(swapped.moves_, 3 * static_cast<int>(SBO_SIZE));
+  EXPECT_EQ(swapped.allocs_, 0);
+  EXPECT_EQ(swapped.frees_, 0);
+  EXPECT_EQ(a.size(), SBO_SIZE);
+  EXPECT_EQ(b.size(), SMALL_SIZE);
+  UseElements(a);
+  UseElements(b);
+}
+
+TEST_F(DataTypeOperationTrackingComplexitySBOVector, MustNotMoveForExternalSwap) {
+  ContainerType a(LARGE_SIZE, create_allocator());
+  ContainerType b(LARGE_SIZE + 1, create_allocator());
+  const auto before = Snapshot();
+  a.swap(b);
+  const auto swapped = Since(before);
+  EXPECT_EQ(swapped.copies_, 0);
+  EXPECT_EQ(swapped.moves_, 0);
+  EXPECT_EQ(swapped.allocs_, 0);
+  UseElements(a);
+  UseElements(b);
+}
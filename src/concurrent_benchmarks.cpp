@@ -0,0 +1,63 @@
+#include "benchmark_common.hpp"
+
+#include "concurrent_sbovector.hpp"
+#include "sbovector.hpp"
+
+#include <memory>
+#include <mutex>
+
+// Multi-producer ingestion into one shared collector
+// Mutex: SBOVector behind a std::mutex (one lock per push_back)
+// Concurrent: ConcurrentSBOVector (one fetch_add per push_back)
+// "items_per_thread" is the throughput of a single producer, flat means perfect scaling
+
+namespace {
+
+constexpr size_t kCollectorSBOSize = 64;
+constexpr int kBatch = 1024;
+
+class MutexCollector {
+  std::mutex mutex_;
+  SBOVector<int, kCollectorSBOSize> values_;
+
+ public:
+  void push_back(int value) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_.push_back(value);
+  }
+};
+
+using ConcurrentCollector = ConcurrentSBOVector<int, kCollectorSBOSize>;
+
+template <typename Collector>
+void RunIngestion(benchmark::State& state) {
+  // shared between the benchmark threads, the loop start/end are barriers
+  static std::unique_ptr<Collector> collector;
+  if (ThreadIndex(state) == 0) {
+    collector = std::make_unique<Collector>();
+  }
+  for (auto _ : state) {
+    for (auto i = 0; i < kBatch; ++i) {
+      collector->push_back(i);
+    }
+  }
+  if (ThreadIndex(state) == 0) {
+    collector.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * kBatch);
+  state.counters["items_per_thread"] = benchmark::Counter(
+    static_cast<double>(state.iterations() * kBatch), benchmark::Counter::kAvgThreadsRate);
+}
+
+}  // namespace
+
+static void BM_IngestMutexSBOVector(benchmark::State& state) {
+  RunIngestion<MutexCollector>(state);
+}
+
+static void BM_IngestConcurrentSBOVector(benchmark::State& state) {
+  RunIngestion<ConcurrentCollector>(state);
+}
+
+BENCHMARK(BM_IngestMutexSBOVector)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_IngestConcurrentSBOVector)->ThreadRange(1, 64)->UseRealTime();
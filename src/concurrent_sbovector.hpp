@@ -0,0 +1,216 @@
+#ifndef CONCURRENT_SBOVECTOR_HPP
+#define CONCURRENT_SBOVECTOR_HPP
+
+#include "sbovector.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+namespace details_ {
+
+inline size_t FloorLog2(size_t value) noexcept {
+  // requires value > 0
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<size_t>(63 - __builtin_clzll(value));
+#else
+  size_t out = 0;
+  while (value >>= 1) {
+    ++out;
+  }
+  return out;
+#endif
+}
+
+}  // namespace details_
+
+// Append only vector for many concurrent producers
+//
+// Slots are reserved with one fetch_add on the reserved count, the storage is a chain of
+// segments: BufferSize inline slots, then allocated segments of BufferSize, 2 * BufferSize,
+// 4 * BufferSize... so growth never moves an element and indexing stays O(1).
+// Every slot has a ready flag, the published count is advanced (by whichever producer
+// gets there) over the prefix of ready slots; readers only ever see [0, size()).
+//
+// Concurrency: push_back/emplace_back/size/operator[]/for_each may run concurrently,
+// destruction requires all producers to have returned.
+template <
+  typename DataType,
+  size_t BufferSize,
+  typename Allocator = std::allocator<DataType>
+>
+class ConcurrentSBOVector {
+  static_assert(BufferSize > 0);
+
+  struct Segment {
+    DataType* data_;
+    std::atomic<uint8_t>* ready_;
+  };
+
+  static constexpr size_t kMaxSegments = 64;
+
+  std::atomic<size_t> reserved_;
+  std::atomic<size_t> published_;
+  std::array<std::atomic<Segment*>, kMaxSegments> segments_;
+  Segment inline_segment_;
+  std::array<std::atomic<uint8_t>, BufferSize> inline_ready_;
+  std::array<details_::AlignedStorage<DataType>, BufferSize> inline_;
+  Allocator alloc_;
+
+  // segment 0 is inline_, segment k > 0 holds [BufferSize << (k - 1), BufferSize << k)
+  static size_t segment_of(size_t index) noexcept {
+    return index < BufferSize ? 0 : details_::FloorLog2(index / BufferSize) + 1;
+  }
+
+  static size_t segment_begin(size_t segment) noexcept {
+    return segment == 0 ? 0 : BufferSize << (segment - 1);
+  }
+
+  static size_t segment_size(size_t segment) noexcept {
+    return segment == 0 ? BufferSize : BufferSize << (segment - 1);
+  }
+
+  Segment* acquire_segment(size_t segment) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    auto out = segments_[segment].load(std::memory_order_acquire);
+    if (out) {
+      return out;
+    }
+    // racing producers may all allocate, the losers free theirs
+    const auto size = segment_size(segment);
+    auto data = alloc_.allocate(size);
+    if (!data) {
+      SBOVECTOR_ASSERT(!SBOVECTOR_SHOULD_THROW_BAD_ALLOC, SBOVEC_OOM);
+      SBOVECTOR_DO_BAD_ALLOC_THROW();
+    }
+    auto created = new Segment{data, new std::atomic<uint8_t>[size]()};
+    if (segments_[segment].compare_exchange_strong(
+          out, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+      return created;
+    }
+    free_segment(created, size);
+    return out;
+  }
+
+  void free_segment(Segment* segment, size_t size) noexcept {
+    alloc_.deallocate(segment->data_, size);
+    delete[] segment->ready_;
+    delete segment;
+  }
+
+  bool is_ready(size_t index) const noexcept {
+    const auto segment = segment_of(index);
+    auto p = segments_[segment].load(std::memory_order_acquire);
+    return p && p->ready_[index - segment_begin(segment)].load();
+  }
+
+  // advance published_ over every ready slot
+  void publish() noexcept {
+    auto published = published_.load();
+    while (is_ready(published)) {
+      // on failure published is reloaded, another producer advanced it
+      if (published_.compare_exchange_weak(published, published + 1)) {
+        ++published;
+      }
+    }
+  }
+
+  template <typename... Args>
+  size_t emplace_back_impl(Args&&... args) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    const auto index = reserved_.fetch_add(1, std::memory_order_relaxed);
+    const auto segment = segment_of(index);
+    auto p = acquire_segment(segment);
+    const auto offset = index - segment_begin(segment);
+    new (p->data_ + offset) DataType(std::forward<Args>(args)...);
+    p->ready_[offset].store(1);
+    publish();
+    return index;
+  }
+
+ public:
+  using value_type = DataType;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using reference = DataType&;
+  using const_reference = const DataType&;
+
+  ConcurrentSBOVector() noexcept : ConcurrentSBOVector(Allocator()) {}
+
+  explicit ConcurrentSBOVector(const Allocator& alloc) noexcept
+      : reserved_(0),
+        published_(0),
+        segments_{},
+        inline_segment_{reinterpret_cast<DataType*>(inline_.data()), inline_ready_.data()},
+        inline_ready_{},
+        alloc_(alloc) {
+    segments_[0].store(&inline_segment_, std::memory_order_relaxed);
+  }
+
+  ConcurrentSBOVector(const ConcurrentSBOVector&) = delete;
+  ConcurrentSBOVector& operator=(const ConcurrentSBOVector&) = delete;
+
+  ~ConcurrentSBOVector() {
+    const auto count = reserved_.load();
+    for (size_t segment = 0; segment < kMaxSegments; ++segment) {
+      auto p = segments_[segment].load();
+      if (!p) {
+        continue;
+      }
+      const auto begin = segment_begin(segment);
+      if (begin < count) {
+        std::destroy_n(p->data_, std::min(segment_size(segment), count - begin));
+      }
+      if (segment > 0) {
+        free_segment(p, segment_size(segment));
+      }
+    }
+  }
+
+  // returns the index of the appended element
+  size_t push_back(const DataType& value) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return emplace_back_impl(value);
+  }
+
+  size_t push_back(DataType&& value) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return emplace_back_impl(std::move(value));
+  }
+
+  template <typename... Args>
+  size_t emplace_back(Args&&... args) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return emplace_back_impl(std::forward<Args>(args)...);
+  }
+
+  // Published count: every element in [0, size()) is fully constructed and visible
+  [[nodiscard]] size_t size() const noexcept {
+    return published_.load(std::memory_order_acquire);
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  // requires index < size()
+  [[nodiscard]] const_reference operator[](size_t index) const noexcept {
+    const auto segment = segment_of(index);
+    return segments_[segment].load(std::memory_order_acquire)
+        ->data_[index - segment_begin(segment)];
+  }
+
+  [[nodiscard]] const_reference at(size_t index) const noexcept {
+    return (*this)[index];
+  }
+
+  // Calls fn(const DataType&) for every element of the published prefix (as of the call)
+  template <typename Fn>
+  void for_each(Fn&& fn) const {
+    const auto count = size();
+    for (size_t segment = 0, begin = 0; begin < count; begin += segment_size(segment++)) {
+      const auto* data = segments_[segment].load(std::memory_order_acquire)->data_;
+      const auto end = std::min(count - begin, segment_size(segment));
+      for (size_t i = 0; i < end; ++i) {
+        fn(data[i]);
+      }
+    }
+  }
+};
+
+#endif  // CONCURRENT_SBOVECTOR_HPP
@@ -0,0 +1,92 @@
+#include "unittest_common.hpp"
+
+#include "concurrent_sbovector.hpp"
+
+#include <atomic>
+#include <thread>
+
+// Unittests for ConcurrentSBOVector
+
+TEST(ValueVerifiedConcurrentSBOVector, MustPushBack) {
+  ConcurrentSBOVector<int, SBO_SIZE> container;
+  EXPECT_TRUE(container.empty());
+  for (auto i = 0; i < static_cast<int>(LARGE_SIZE * 10); ++i) {
+    EXPECT_EQ(container.push_back(i), static_cast<size_t>(i));
+  }
+  ASSERT_EQ(container.size(), LARGE_SIZE * 10);
+  for (auto i = 0u; i < container.size(); ++i) {
+    EXPECT_EQ(container[i], static_cast<int>(i));
+  }
+  std::vector<int> seen;
+  container.for_each([&seen](int value) { seen.push_back(value); });
+  EXPECT_RANGE_EQ(seen, make_vector_sequence<LARGE_SIZE * 10>());
+}
+
+TEST(ValueVerifiedConcurrentSBOVector, MustNotMoveElements) {
+  ConcurrentSBOVector<int, SMALL_SIZE> container;
+  std::vector<const int*> addresses;
+  for (auto i = 0; i < static_cast<int>(LARGE_SIZE); ++i) {
+    addresses.push_back(&container[container.push_back(i)]);
+  }
+  for (auto i = 0u; i < LARGE_SIZE; ++i) {
+    EXPECT_EQ(&container[i], addresses[i]);
+  }
+}
+
+TEST(ValueVerifiedConcurrentSBOVector, MustPushBackConcurrently) {
+  constexpr int kThreads = 8;
+  constexpr int kPerThread = 20000;
+  ConcurrentSBOVector<int, SBO_SIZE> container;
+  std::atomic<bool> done{false};
+  std::atomic<int> reader_errors{0};
+
+  // readers only ever observe fully constructed elements of the published prefix
+  std::thread reader([&]() {
+    while (!done.load()) {
+      size_t count = 0;
+      container.for_each([&](int value) {
+        ++count;
+        if (value < 0 || value >= kThreads * kPerThread) {
+          ++reader_errors;
+        }
+      });
+      if (count > container.size()) {
+        ++reader_errors;
+      }
+    }
+  });
+  std::vector<std::thread> producers;
+  for (auto t = 0; t < kThreads; ++t) {
+    producers.emplace_back([&container, t]() {
+      for (auto i = 0; i < kPerThread; ++i) {
+        container.push_back(t * kPerThread + i);
+      }
+    });
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  done.store(true);
+  reader.join();
+
+  EXPECT_EQ(reader_errors.load(), 0);
+  ASSERT_EQ(container.size(), static_cast<size_t>(kThreads * kPerThread));
+  std::vector<int> values;
+  container.for_each([&values](int value) { values.push_back(value); });
+  std::sort(values.begin(), values.end());
+  for (auto i = 0u; i < values.size(); ++i) {
+    ASSERT_EQ(values[i], static_cast<int>(i));
+  }
+}
+
+TEST_F(DataTypeOperationTrackingSBOVector, MustDestroyConcurrentSBOVector) {
+  {
+    ConcurrentSBOVector<DataType, SBO_SIZE, AllocatorType> container(create_allocator());
+    for (auto i = 0u; i < LARGE_SIZE; ++i) {
+      container.emplace_back();
+    }
+    container.push_back(DataType());
+    container.for_each([](const DataType& value) { value.Use(); });
+  }
+  EXPECT_EQ(OperationCounter::TOTALS.copies(), 0);
+}
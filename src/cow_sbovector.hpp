@@ -0,0 +1,478 @@
+#ifndef COW_SBOVECTOR_HPP
+#define COW_SBOVECTOR_HPP
+
+#include "sbovector.hpp"
+
+#include <atomic>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+namespace details_ {
+
+// Reference counted holder for the contents of a spilled CowSBOVector
+// the count follows std::shared_ptr rules: relaxed increments, acq_rel decrements
+// data_ is null while the buffer is lent back to a CowSBOVector for a mutation
+template <typename DataType, typename Allocator>
+struct CowSharedBuffer {
+  std::atomic<size_t> references_;
+  DataType* data_;
+  size_t count_;
+  size_t capacity_;
+  Allocator alloc_;
+
+  explicit CowSharedBuffer(const Allocator& alloc) noexcept
+      : references_(1), data_(nullptr), count_(0), capacity_(0), alloc_(alloc) {}
+
+  CowSharedBuffer(const CowSharedBuffer&) = delete;
+  CowSharedBuffer& operator=(const CowSharedBuffer&) = delete;
+
+  ~CowSharedBuffer() {
+    if (data_) {
+      std::destroy_n(data_, count_);
+      alloc_.deallocate(data_, capacity_);
+    }
+  }
+
+  void acquire() noexcept { references_.fetch_add(1, std::memory_order_relaxed); }
+
+  void release() noexcept {
+    if (references_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+      delete this;
+    }
+  }
+
+  bool unique() const noexcept {
+    return references_.load(std::memory_order_acquire) == 1;
+  }
+};
+
+}  // namespace details_
+
+// Copy on write flavour of SBOVector
+//
+// Inline contents are copied by value exactly like SBOVector,
+// spilled contents are held in a reference counted buffer that copies share,
+// the first mutation through the non-const API of a shared copy makes it a private copy.
+//
+// The reference count is thread safe (same guarantees as std::shared_ptr):
+// distinct CowSBOVectors sharing a buffer may be read/copied/mutated/destroyed concurrently.
+//
+// NOTE: non-const pointers/references/iterators are only valid until the CowSBOVector
+// (or a copy of it) is copied, writing through them after a copy will be visible in the copy.
+// NOTE: the shared buffer header (reference count, buffer, size, capacity, Allocator) is
+// allocated with operator new, element storage still comes from Allocator
+template <
+  typename DataType,
+  size_t BufferSize,
+  typename Allocator = std::allocator<DataType>,
+  bool UseCompactStorage = false
+>
+class CowSBOVector {
+ public:
+  using vector_type = SBOVector<DataType, BufferSize, Allocator, UseCompactStorage>;
+  using value_type = DataType;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using pointer = DataType*;
+  using const_pointer = const DataType*;
+  using iterator = DataType*;
+  using const_iterator = const DataType*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using reference = DataType&;
+  using const_reference = const DataType&;
+
+ private:
+  using SharedBuffer = details_::CowSharedBuffer<DataType, Allocator>;
+
+  // Invariant: if shared_ is set local_ is empty (and therefore inline)
+  // and the shared contents are spilled (more than BufferSize elements)
+  // (outside of mutate(), which lends the buffer back to local_)
+  vector_type local_;
+  SharedBuffer* shared_;
+
+  // Makes the contents private and lends a spilled buffer to local_,
+  // shared contents are copied into room for reserve_hint elements
+  // so the mutation that follows does not have to grow the copy again
+  vector_type& unique_contents(size_t reserve_hint) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    if (!shared_) {
+      return local_;
+    }
+    if (shared_->unique()) {
+      local_.adopt_external(shared_->data_, shared_->count_, shared_->capacity_);
+      shared_->data_ = nullptr;
+      return local_;
+    }
+    local_.copy_reserved(shared_->data_, shared_->count_, reserve_hint);
+    release();
+    return local_;
+  }
+
+  // Gives a buffer lent by unique_contents() back to its header on scope exit
+  // (also when the mutation throws), drops the header if the contents fit inline again
+  class LendGuard {
+   public:
+    explicit LendGuard(CowSBOVector& owner) noexcept : owner_(owner) {}
+    LendGuard(const LendGuard&) = delete;
+    LendGuard& operator=(const LendGuard&) = delete;
+
+    ~LendGuard() {
+      auto shared = owner_.shared_;
+      if (!shared || shared->data_) {
+        return;
+      }
+      if (owner_.local_.size() <= BufferSize) {
+        owner_.release();
+      } else {
+        owner_.hand_over(*shared);
+      }
+    }
+
+   private:
+    CowSBOVector& owner_;
+  };
+
+  // Runs mutation(vector_type&) on private contents, see unique_contents()
+  template <typename Mutation>
+  void mutate(size_t reserve_hint, Mutation&& mutation) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    {
+      const LendGuard lend(*this);
+      mutation(unique_contents(reserve_hint));
+    }
+    settle();
+  }
+
+  void hand_over(SharedBuffer& shared) noexcept {
+    shared.count_ = local_.size();
+    shared.capacity_ = local_.capacity();
+    shared.data_ = local_.release_external();
+  }
+
+  // Moves spilled local_ contents into a shareable buffer,
+  // called after every operation that can grow local_
+  void settle() SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    if (!shared_ && local_.size() > BufferSize) {
+      shared_ = new SharedBuffer(local_.get_allocator());
+      hand_over(*shared_);
+    }
+  }
+
+  void release() noexcept {
+    if (shared_) {
+      shared_->release();
+      shared_ = nullptr;
+    }
+  }
+
+  size_t index_of(const_iterator pos) const noexcept {
+    return static_cast<size_t>(std::distance(cbegin(), pos));
+  }
+
+ public:
+  CowSBOVector() noexcept : local_(), shared_(nullptr) {}
+
+  explicit CowSBOVector(const Allocator& alloc) noexcept
+      : local_(alloc), shared_(nullptr) {}
+
+  CowSBOVector(
+        size_t count,
+        const DataType& value,
+        const Allocator& alloc = Allocator()
+      ) SBOVECTOR_NOEXCEPT_COND_ALLOC : local_(count, value, alloc), shared_(nullptr) {
+    settle();
+  }
+
+  explicit CowSBOVector(
+        size_t count,
+        const Allocator& alloc = Allocator()
+      ) SBOVECTOR_NOEXCEPT_COND_ALLOC : local_(count, alloc), shared_(nullptr) {
+    settle();
+  }
+
+  template <
+    typename InputIter,
+    typename = std::enable_if_t<details_::is_iterator_v<InputIter>>
+  >
+  CowSBOVector(
+        InputIter p_begin,
+        InputIter p_end,
+        const Allocator& alloc = Allocator()
+      ) SBOVECTOR_NOEXCEPT_COND_ALLOC : local_(p_begin, p_end, alloc), shared_(nullptr) {
+    settle();
+  }
+
+  CowSBOVector(
+        std::initializer_list<DataType> init_list,
+        const Allocator& alloc = Allocator()
+      ) SBOVECTOR_NOEXCEPT_COND_ALLOC : local_(init_list, alloc), shared_(nullptr) {
+    settle();
+  }
+
+  explicit CowSBOVector(const vector_type& copy) SBOVECTOR_NOEXCEPT_COND_ALLOC
+      : local_(copy), shared_(nullptr) {
+    settle();
+  }
+
+  explicit CowSBOVector(vector_type&& move_from) SBOVECTOR_NOEXCEPT_COND_ALLOC
+      : local_(std::move(move_from)), shared_(nullptr) {
+    settle();
+  }
+
+  CowSBOVector(const CowSBOVector& copy) SBOVECTOR_NOEXCEPT_COND_ALLOC
+      : local_(copy.local_), shared_(copy.shared_) {
+    if (shared_) {
+      shared_->acquire();
+    }
+  }
+
+  CowSBOVector(CowSBOVector&& move_from) noexcept
+      : local_(std::move(move_from.local_)),
+        shared_(std::exchange(move_from.shared_, nullptr)) {}
+
+  ~CowSBOVector() { release(); }
+
+  CowSBOVector& operator=(const CowSBOVector& other) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    if (this != &other) {
+      CowSBOVector copy(other);
+      swap(copy);
+    }
+    return *this;
+  }
+
+  CowSBOVector& operator=(CowSBOVector&& other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  CowSBOVector& operator=(std::initializer_list<DataType> init)
+      SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    assign(init.begin(), init.end());
+    return *this;
+  }
+
+  void assign(size_t count, const DataType& value) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    release();
+    local_.assign(count, value);
+    settle();
+  }
+
+  template <
+    typename InputIt,
+    typename = std::enable_if_t<details_::is_iterator_v<InputIt>>
+  >
+  void assign(InputIt p_begin, InputIt p_end) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    release();
+    local_.assign(p_begin, p_end);
+    settle();
+  }
+
+  void assign(std::initializer_list<DataType> list) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    assign(list.begin(), list.end());
+  }
+
+  [[nodiscard]] Allocator get_allocator() const noexcept { return local_.get_allocator(); }
+
+  // Number of CowSBOVectors sharing these contents (1 for inline/unshared contents)
+  [[nodiscard]] size_t use_count() const noexcept {
+    return shared_ ? shared_->references_.load(std::memory_order_relaxed) : 1;
+  }
+
+  [[nodiscard]] reference at(size_t index) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return *(data() + index);
+  }
+  [[nodiscard]] const_reference at(size_t index) const noexcept {
+    return *(data() + index);
+  }
+
+  [[nodiscard]] reference operator[](size_t index) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return at(index);
+  }
+  [[nodiscard]] const_reference operator[](size_t index) const noexcept {
+    return at(index);
+  }
+
+  [[nodiscard]] reference front() SBOVECTOR_NOEXCEPT_COND_ALLOC { return at(0); }
+  [[nodiscard]] const_reference front() const noexcept { return at(0); }
+
+  [[nodiscard]] reference back() SBOVECTOR_NOEXCEPT_COND_ALLOC { return at(size() - 1); }
+  [[nodiscard]] const_reference back() const noexcept { return at(size() - 1); }
+
+  [[nodiscard]] pointer data() SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    if (shared_ && !shared_->unique()) {
+      // a mutation through the returned pointer needs no room to grow: exact fit copy
+      mutate(0, [](vector_type&) {});
+    }
+    return shared_ ? shared_->data_ : local_.data();
+  }
+  [[nodiscard]] const_pointer data() const noexcept {
+    return shared_ ? shared_->data_ : local_.data();
+  }
+  [[nodiscard]] const_pointer cdata() const noexcept { return data(); }
+
+  [[nodiscard]] iterator begin() SBOVECTOR_NOEXCEPT_COND_ALLOC { return data(); }
+  [[nodiscard]] const_iterator begin() const noexcept { return data(); }
+  [[nodiscard]] const_iterator cbegin() const noexcept { return begin(); }
+
+  [[nodiscard]] iterator end() SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return begin() + size();
+  }
+  [[nodiscard]] const_iterator end() const noexcept { return cbegin() + size(); }
+  [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+  [[nodiscard]] reverse_iterator rbegin() SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return std::make_reverse_iterator(end());
+  }
+  [[nodiscard]] const_reverse_iterator rbegin() const noexcept {
+    return std::make_reverse_iterator(cend());
+  }
+  [[nodiscard]] const_reverse_iterator crbegin() const noexcept {
+    return rbegin();
+  }
+  [[nodiscard]] reverse_iterator rend() SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return std::make_reverse_iterator(begin());
+  }
+  [[nodiscard]] const_reverse_iterator rend() const noexcept {
+    return std::make_reverse_iterator(cbegin());
+  }
+  [[nodiscard]] const_reverse_iterator crend() const noexcept {
+    return rend();
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return 0 == size(); }
+  [[nodiscard]] size_t size() const noexcept {
+    return shared_ ? shared_->count_ : local_.size();
+  }
+  [[nodiscard]] size_t max_size() const noexcept { return local_.max_size(); }
+  [[nodiscard]] size_t capacity() const noexcept {
+    return shared_ ? shared_->capacity_ : local_.capacity();
+  }
+
+  void reserve_if_external(size_t requested_capacity) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    if (requested_capacity <= capacity() || size() <= BufferSize)
+      return;
+    mutate(requested_capacity, [&](vector_type& contents) {
+      contents.reserve_if_external(requested_capacity);
+    });
+  }
+
+  void shrink_to_fit_if_external() SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    if ((size() <= BufferSize) || (size() == capacity()))
+      return;
+    mutate(0, [](vector_type& contents) { contents.shrink_to_fit_if_external(); });
+  }
+
+  void clear() noexcept {
+    // dropping a reference is always cheaper than copying to then clear
+    release();
+    local_.clear();
+  }
+
+  iterator insert(const_iterator pos, const DataType& v) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return insert(pos, 1, v);
+  }
+
+  iterator insert(const_iterator pos, DataType&& mv) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    const auto i_pos = index_of(pos);
+    mutate(size() + 1, [&](vector_type& contents) {
+      contents.insert(contents.cbegin() + i_pos, std::move(mv));
+    });
+    return begin() + i_pos;
+  }
+
+  iterator insert(
+        const_iterator pos,
+        size_t count,
+        const DataType& v
+      ) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    const auto i_pos = index_of(pos);
+    mutate(size() + count, [&](vector_type& contents) {
+      contents.insert(contents.cbegin() + i_pos, count, v);
+    });
+    return begin() + i_pos;
+  }
+
+  template <
+    typename InputIt,
+    typename = std::enable_if_t<details_::is_iterator_v<InputIt>>
+  >
+  iterator insert(
+        const_iterator pos,
+        InputIt p_begin,
+        InputIt p_end
+      ) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    const auto i_pos = index_of(pos);
+    const auto count = static_cast<size_t>(std::distance(p_begin, p_end));
+    mutate(size() + count, [&](vector_type& contents) {
+      contents.insert(contents.cbegin() + i_pos, p_begin, p_end);
+    });
+    return begin() + i_pos;
+  }
+
+  iterator insert(
+        const_iterator pos,
+        std::initializer_list<DataType> list
+      ) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return insert(pos, list.begin(), list.end());
+  }
+
+  template <typename... Args>
+  iterator emplace(const_iterator pos, Args&&... args) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    const auto i_pos = index_of(pos);
+    mutate(size() + 1, [&](vector_type& contents) {
+      contents.emplace(contents.cbegin() + i_pos, std::forward<Args>(args)...);
+    });
+    return begin() + i_pos;
+  }
+
+  iterator erase(const_iterator pos) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return erase(pos, pos + 1);
+  }
+
+  iterator erase(const_iterator p_begin, const_iterator p_end)
+      SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    const auto i_begin = index_of(p_begin);
+    const auto i_end = index_of(p_end);
+    mutate(0, [&](vector_type& contents) {
+      contents.erase(contents.cbegin() + i_begin, contents.cbegin() + i_end);
+    });
+    return begin() + i_begin;
+  }
+
+  void push_back(const DataType& value) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    emplace_back(value);
+  }
+
+  void push_back(DataType&& value) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    emplace_back(std::forward<DataType>(value));
+  }
+
+  template <typename... Args>
+  reference emplace_back(Args&&... args) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    mutate(size() + 1, [&](vector_type& contents) {
+      contents.emplace_back(std::forward<Args>(args)...);
+    });
+    return back();
+  }
+
+  void pop_back() SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    mutate(0, [](vector_type& contents) { contents.pop_back(); });
+  }
+
+  void resize(size_t count) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    mutate(count, [&](vector_type& contents) { contents.resize(count); });
+  }
+
+  void resize(size_t count, const DataType& v) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    mutate(count, [&](vector_type& contents) { contents.resize(count, v); });
+  }
+
+  // Swaps never copy shared contents
+  void swap(CowSBOVector& that) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    local_.swap(that.local_);
+    std::swap(shared_, that.shared_);
+  }
+};
+
+#endif  // COW_SBOVECTOR_HPP
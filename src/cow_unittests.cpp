@@ -0,0 +1,139 @@
+#include "unittest_common.hpp"
+
+#include "cow_sbovector.hpp"
+
+#include <thread>
+
+// Unittests for CowSBOVector (shared spill buffers)
+
+struct DataTypeOperationTrackingCowSBOVector : public DataTypeOperationTrackingSBOVector {
+  using CowContainerType = CowSBOVector<DataType, SBO_SIZE, AllocatorType>;
+};
+
+TEST_F(DataTypeOperationTrackingCowSBOVector, MustShareExternalOnCopy) {
+  const CowContainerType original(LARGE_SIZE, create_allocator());
+  const auto copies = OperationCounter::TOTALS.copies();
+  const auto allocs = totals_.allocs_;
+  {
+    CowContainerType copy(original);
+    EXPECT_EQ(OperationCounter::TOTALS.copies(), copies);
+    EXPECT_EQ(totals_.allocs_, allocs);
+    EXPECT_EQ(original.use_count(), 2);
+    EXPECT_EQ(copy.use_count(), 2);
+    EXPECT_EQ(copy.cdata(), original.cdata());
+    UseElements(copy);
+  }
+  EXPECT_EQ(original.use_count(), 1);
+  UseElements(original);
+}
+
+TEST_F(DataTypeOperationTrackingCowSBOVector, MustCopyInlineByValue) {
+  const CowContainerType original(SMALL_SIZE, create_allocator());
+  const auto copies = OperationCounter::TOTALS.copies();
+  CowContainerType copy(original);
+  EXPECT_EQ(OperationCounter::TOTALS.copies(), copies + static_cast<int>(SMALL_SIZE));
+  EXPECT_EQ(original.use_count(), 1);
+  EXPECT_EQ(copy.use_count(), 1);
+  EXPECT_NE(copy.cdata(), original.cdata());
+  UseElements(copy);
+}
+
+TEST_F(DataTypeOperationTrackingCowSBOVector, MustCopyOnWrite) {
+  CowContainerType original(LARGE_SIZE, create_allocator());
+  CowContainerType copy(original);
+  const auto copies = OperationCounter::TOTALS.copies();
+  const auto moves = OperationCounter::TOTALS.moves();
+  const auto allocs = totals_.allocs_;
+  copy.push_back(DataType());
+  // private copy of every element, one allocation for the private buffer
+  // (reserved for the pushed element, so push_back does not grow it again)
+  EXPECT_EQ(OperationCounter::TOTALS.copies(), copies + static_cast<int>(LARGE_SIZE));
+  EXPECT_EQ(totals_.allocs_, allocs + 1);
+  EXPECT_EQ(OperationCounter::TOTALS.moves(), moves + 1);  // only the pushed temporary
+  EXPECT_EQ(original.use_count(), 1);
+  EXPECT_EQ(copy.use_count(), 1);
+  EXPECT_EQ(original.size(), LARGE_SIZE);
+  EXPECT_EQ(copy.size(), LARGE_SIZE + 1);
+  UseElements(original);
+  UseElements(copy);
+}
+
+TEST_F(DataTypeOperationTrackingCowSBOVector, MustNotCopyWhenUnique) {
+  CowContainerType container(LARGE_SIZE, create_allocator());
+  const auto copies = OperationCounter::TOTALS.copies();
+  container[0] = DataType();
+  container.erase(container.begin());
+  container.push_back(DataType());
+  EXPECT_EQ(OperationCounter::TOTALS.copies(), copies);
+  EXPECT_EQ(container.size(), LARGE_SIZE);
+  UseElements(container);
+}
+
+TEST_F(DataTypeOperationTrackingCowSBOVector, MustNotCopyOnConstAccess) {
+  CowContainerType original(LARGE_SIZE, create_allocator());
+  const CowContainerType copy(original);
+  const auto copies = OperationCounter::TOTALS.copies();
+  UseElements(copy);
+  copy.at(0).Use();
+  copy.back().Use();
+  EXPECT_EQ(OperationCounter::TOTALS.copies(), copies);
+  EXPECT_EQ(original.use_count(), 2);
+}
+
+TEST_F(DataTypeOperationTrackingCowSBOVector, MustNotCopyOnClearOrAssign) {
+  CowContainerType original(LARGE_SIZE, create_allocator());
+  CowContainerType a(original), b(original);
+  const auto copies = OperationCounter::TOTALS.copies();
+  a.clear();
+  b.assign(SMALL_SIZE, DataType());
+  // only the assigned values are copied, never the shared contents
+  EXPECT_EQ(OperationCounter::TOTALS.copies(), copies + static_cast<int>(SMALL_SIZE));
+  EXPECT_EQ(original.use_count(), 1);
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(b.size(), SMALL_SIZE);
+  UseElements(b);
+}
+
+TEST_F(DataTypeOperationTrackingCowSBOVector, MustShareAfterGrowth) {
+  CowContainerType container(SMALL_SIZE, create_allocator());
+  container.resize(LARGE_SIZE);
+  const auto copies = OperationCounter::TOTALS.copies();
+  CowContainerType copy(container);
+  EXPECT_EQ(OperationCounter::TOTALS.copies(), copies);
+  EXPECT_EQ(container.use_count(), 2);
+  UseElements(copy);
+}
+
+TEST(ValueVerifiedCowSBOVector, MustCopyOnWrite) {
+  auto vec = make_vector_sequence<LARGE_SIZE>();
+  CowSBOVector<int, SBO_SIZE> original(vec.begin(), vec.end());
+  CowSBOVector<int, SBO_SIZE> copy(original);
+  copy[0] = -1;
+  copy.insert(copy.begin() + 1, -2);
+  EXPECT_RANGE_EQ(original, vec);
+  vec[0] = -1;
+  vec.insert(vec.begin() + 1, -2);
+  EXPECT_RANGE_EQ(copy, vec);
+}
+
+TEST(ValueVerifiedCowSBOVector, MustShareAcrossThreads) {
+  auto vec = make_vector_sequence<LARGE_SIZE>();
+  const CowSBOVector<int, SBO_SIZE> original(vec.begin(), vec.end());
+  std::vector<std::thread> threads;
+  for (auto t = 0; t < 4; ++t) {
+    threads.emplace_back([&original, &vec]() {
+      for (auto i = 0; i < 1000; ++i) {
+        CowSBOVector<int, SBO_SIZE> copy(original);
+        if (i % 10 == 0) {
+          copy.push_back(i);
+          EXPECT_EQ(copy.size(), LARGE_SIZE + 1);
+        }
+      }
+      EXPECT_RANGE_EQ(original, vec);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(original.use_count(), 1);
+}
@@ -0,0 +1,401 @@
+#ifndef INCREMENTAL_SBOVECTOR_HPP
+#define INCREMENTAL_SBOVECTOR_HPP
+
+#include "sbovector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// SBOVector flavour whose external growth relocates incrementally, bounding push_back latency
+//
+// Leaving the inline buffer relocates at most BufferSize elements at once, as SBOVector does.
+// Growing an external buffer instead allocates the new buffer and leaves the elements where
+// they are: while growing() the old buffer holds the indices not yet migrated and every
+// append moves the next MigrationChunk of them over (the old buffer is freed with the last).
+// A transition of N elements ends within N / MigrationChunk appends, before the doubled
+// buffer can fill up, so no append ever moves more than max(BufferSize, MigrationChunk).
+//
+// Indexing stays O(1) (one extra compare) while growing. Contiguous access: data(), begin()
+// and end() finish the transition first (an O(size) step, call finish_growth() to choose
+// when), iterators and pointers are invalidated by any append, as for any vector.
+// Const access never finishes a transition (a const object is never written): const
+// iterators index through the transition, there is no const data().
+// Moves and swaps take a transition over as is, in O(1).
+// NOTE: the new buffer is requested in one allocation, for very large buffers the allocator
+// (eg: mmap/munmap of the old buffer) may still stall; see latency_benchmarks.cpp
+template <
+  typename DataType,
+  size_t BufferSize,
+  typename Allocator = std::allocator<DataType>,
+  size_t MigrationChunk = 16
+>
+class IncrementalSBOVector {
+  static_assert(MigrationChunk > 0, "a transition must make progress on every append");
+  static_assert(details_::kRelaxedExceptions || std::is_nothrow_move_constructible_v<DataType>);
+
+ public:
+  using value_type = DataType;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+  using pointer = DataType*;
+  using const_pointer = const DataType*;
+  using iterator = DataType*;
+  class const_iterator;
+  using reference = DataType&;
+  using const_reference = const DataType&;
+
+ private:
+  std::array<details_::AlignedStorage<DataType>, BufferSize> inline_;
+  Allocator alloc_;
+  // inline_ or external, the new buffer while growing
+  DataType* data_;
+  size_t size_;
+  size_t capacity_;
+  // while growing: indices [migrated_, old_size_) are still in old_
+  DataType* old_;
+  size_t old_capacity_;
+  size_t old_size_;
+  size_t migrated_;
+
+  DataType* inline_data() noexcept {
+    return static_cast<DataType*>(static_cast<void*>(inline_.data()));
+  }
+
+  bool is_inline() const noexcept {
+    return static_cast<const void*>(data_) == static_cast<const void*>(inline_.data());
+  }
+
+  DataType* slot(size_t index) const noexcept {
+    return (index >= migrated_ && index < old_size_) ? old_ + index : data_ + index;
+  }
+
+  void reset_inline() noexcept {
+    data_ = inline_data();
+    size_ = 0;
+    capacity_ = BufferSize;
+    old_ = nullptr;
+    old_capacity_ = old_size_ = migrated_ = 0;
+  }
+
+  DataType* allocate(size_t count) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    auto out = alloc_.allocate(count);
+    if (!out) {
+      SBOVECTOR_ASSERT(!SBOVECTOR_SHOULD_THROW_BAD_ALLOC, SBOVEC_OOM);
+      SBOVECTOR_DO_BAD_ALLOC_THROW();
+    }
+    return out;
+  }
+
+  // moves [first, first + count) of from into the same indices of to
+  static void relocate(DataType* from, DataType* to, size_t first, size_t count) noexcept {
+    if constexpr (std::is_trivially_copyable_v<DataType>) {
+      std::memcpy(static_cast<void*>(to + first), static_cast<void*>(from + first),
+                  count * sizeof(DataType));
+    } else {
+      std::uninitialized_move(from + first, from + first + count, to + first);
+      std::destroy(from + first, from + first + count);
+    }
+  }
+
+  void migrate(size_t count) noexcept {
+    const auto step = std::min(count, old_size_ - migrated_);
+    relocate(old_, data_, migrated_, step);
+    migrated_ += step;
+    if (migrated_ == old_size_) {
+      alloc_.deallocate(old_, old_capacity_);
+      old_ = nullptr;
+      old_capacity_ = old_size_ = migrated_ = 0;
+    }
+  }
+
+  // Appends DataType(args...) to a full vector: the inline buffer spills at once, an external
+  // buffer starts a transition (args may refer to an element, constructed before relocating)
+  template <typename... Args>
+  void emplace_back_with_growth(Args&&... args) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    if (old_) {
+      finish_growth();
+    }
+    const auto new_capacity = std::max<size_t>(details_::SuggestGrowth(capacity_), 1);
+    auto new_data = allocate(new_capacity);
+    new (new_data + size_) DataType(std::forward<Args>(args)...);
+    if (is_inline()) {
+      relocate(data_, new_data, 0, size_);
+    } else {
+      old_ = data_;
+      old_capacity_ = capacity_;
+      old_size_ = size_;
+      migrated_ = 0;
+    }
+    data_ = new_data;
+    capacity_ = new_capacity;
+    ++size_;
+  }
+
+  // Takes the contents of other (leaving it empty), *this must be empty and inline
+  // (a transition is taken over as is: only external buffers grow incrementally)
+  void take(IncrementalSBOVector& other) noexcept {
+    if (other.is_inline()) {
+      relocate(other.data_, data_, 0, other.size_);
+      size_ = other.size_;
+      other.size_ = 0;
+      return;
+    }
+    data_ = other.data_;
+    size_ = other.size_;
+    capacity_ = other.capacity_;
+    old_ = other.old_;
+    old_capacity_ = other.old_capacity_;
+    old_size_ = other.old_size_;
+    migrated_ = other.migrated_;
+    other.reset_inline();
+  }
+
+  void release() noexcept {
+    for (size_t i = 0; i < size_; ++i) {
+      std::destroy_at(slot(i));
+    }
+    if (old_) {
+      alloc_.deallocate(old_, old_capacity_);
+    }
+    if (!is_inline()) {
+      alloc_.deallocate(data_, capacity_);
+    }
+    reset_inline();
+  }
+
+ public:
+  IncrementalSBOVector() noexcept : IncrementalSBOVector(Allocator()) {}
+
+  explicit IncrementalSBOVector(const Allocator& alloc) noexcept : alloc_(alloc) {
+    reset_inline();
+  }
+
+  // exact capacity, not growing
+  IncrementalSBOVector(const IncrementalSBOVector& copy) SBOVECTOR_NOEXCEPT_COND_ALLOC
+      : IncrementalSBOVector(copy.alloc_) {
+    if (copy.size_ > BufferSize) {
+      data_ = allocate(copy.size_);
+      capacity_ = copy.size_;
+    }
+    for (; size_ < copy.size_; ++size_) {
+      new (data_ + size_) DataType(copy[size_]);
+    }
+  }
+
+  IncrementalSBOVector(IncrementalSBOVector&& move_from) noexcept
+      : IncrementalSBOVector(move_from.alloc_) {
+    take(move_from);
+  }
+
+  ~IncrementalSBOVector() { release(); }
+
+  IncrementalSBOVector& operator=(const IncrementalSBOVector& other) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    if (this != &other) {
+      IncrementalSBOVector copy(other);
+      swap(copy);
+    }
+    return *this;
+  }
+
+  // allocators are not propagated: unequal allocators move element by element
+  IncrementalSBOVector& operator=(IncrementalSBOVector&& other) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    if (this == &other) {
+      return *this;
+    }
+    release();
+    if (other.is_inline() || alloc_ == other.alloc_) {
+      take(other);
+      return *this;
+    }
+    if (other.size_ > BufferSize) {
+      data_ = allocate(other.size_);
+      capacity_ = other.size_;
+    }
+    for (; size_ < other.size_; ++size_) {
+      new (data_ + size_) DataType(std::move(other[size_]));
+    }
+    other.release();
+    return *this;
+  }
+
+  void swap(IncrementalSBOVector& other) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    if (this == &other) {
+      return;
+    }
+    IncrementalSBOVector temp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(temp);
+  }
+
+  [[nodiscard]] Allocator get_allocator() const noexcept { return alloc_; }
+
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+  [[nodiscard]] bool empty() const noexcept { return size_ == 0; }
+  [[nodiscard]] size_t capacity() const noexcept { return capacity_; }
+
+  // true while part of the contents is still in the previous external buffer
+  [[nodiscard]] bool growing() const noexcept { return old_ != nullptr; }
+
+  // Completes a transition at once (O(elements not yet migrated))
+  void finish_growth() noexcept {
+    if (old_) {
+      migrate(old_size_);
+    }
+  }
+
+  DataType& operator[](size_t index) noexcept { return *slot(index); }
+  const DataType& operator[](size_t index) const noexcept { return *slot(index); }
+
+  DataType& at(size_t index) noexcept {
+    SBOVECTOR_ASSERT(index < size_, "Out of bounds");
+    return *slot(index);
+  }
+  const DataType& at(size_t index) const noexcept {
+    SBOVECTOR_ASSERT(index < size_, "Out of bounds");
+    return *slot(index);
+  }
+
+  DataType& front() noexcept { return *slot(0); }
+  const DataType& front() const noexcept { return *slot(0); }
+  DataType& back() noexcept { return *slot(size_ - 1); }
+  const DataType& back() const noexcept { return *slot(size_ - 1); }
+
+  // (no const data(): a growing vector is not contiguous, see const_iterator)
+  DataType* data() noexcept {
+    finish_growth();
+    return data_;
+  }
+
+  iterator begin() noexcept { return data(); }
+  iterator end() noexcept { return data() + size_; }
+  const_iterator begin() const noexcept { return {this, 0}; }
+  const_iterator end() const noexcept { return {this, size_}; }
+  const_iterator cbegin() const noexcept { return {this, 0}; }
+  const_iterator cend() const noexcept { return {this, size_}; }
+
+  template <typename... Args>
+  DataType& emplace_back(Args&&... args) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    if (size_ == capacity_) {
+      emplace_back_with_growth(std::forward<Args>(args)...);
+    } else {
+      // appended indices are never in the old buffer
+      new (data_ + size_) DataType(std::forward<Args>(args)...);
+      ++size_;
+    }
+    if (old_) {
+      migrate(MigrationChunk);
+    }
+    return data_[size_ - 1];
+  }
+
+  void push_back(const DataType& value) SBOVECTOR_NOEXCEPT_COND_ALLOC { emplace_back(value); }
+  void push_back(DataType&& value) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    emplace_back(std::move(value));
+  }
+
+  // O(1) while growing: the old buffer gives up the popped index
+  void pop_back() noexcept {
+    SBOVECTOR_ASSERT(size_ > 0, "pop_back on empty IncrementalSBOVector");
+    std::destroy_at(slot(--size_));
+    if (old_ && size_ < old_size_) {
+      old_size_ = size_;
+      if (migrated_ >= old_size_) {
+        migrated_ = old_size_;
+        migrate(0);
+      }
+    }
+  }
+
+  // Destroys every element and returns to the inline buffer (as SBOVector::clear)
+  void clear() noexcept { release(); }
+};
+
+// An index into the vector, dereferenced through slot(): valid while growing without
+// writing to the vector (so concurrent const readers do not race)
+template <typename DataType, size_t BufferSize, typename Allocator, size_t MigrationChunk>
+class IncrementalSBOVector<DataType, BufferSize, Allocator, MigrationChunk>::const_iterator {
+  const IncrementalSBOVector* vector_;
+  size_t index_;
+
+ public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = DataType;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const DataType*;
+  using reference = const DataType&;
+
+  const_iterator() noexcept : vector_(nullptr), index_(0) {}
+  const_iterator(const IncrementalSBOVector* vector, size_t index) noexcept
+      : vector_(vector), index_(index) {}
+
+  reference operator*() const noexcept { return *vector_->slot(index_); }
+  pointer operator->() const noexcept { return vector_->slot(index_); }
+  reference operator[](difference_type offset) const noexcept { return *(*this + offset); }
+
+  const_iterator& operator++() noexcept {
+    ++index_;
+    return *this;
+  }
+  const_iterator operator++(int) noexcept {
+    auto out = *this;
+    ++index_;
+    return out;
+  }
+  const_iterator& operator--() noexcept {
+    --index_;
+    return *this;
+  }
+  const_iterator operator--(int) noexcept {
+    auto out = *this;
+    --index_;
+    return out;
+  }
+
+  // (unsigned wrap around: adding a negative offset is well defined)
+  const_iterator& operator+=(difference_type offset) noexcept {
+    index_ += static_cast<size_t>(offset);
+    return *this;
+  }
+  const_iterator& operator-=(difference_type offset) noexcept {
+    index_ -= static_cast<size_t>(offset);
+    return *this;
+  }
+  friend const_iterator operator+(const_iterator it, difference_type offset) noexcept {
+    return it += offset;
+  }
+  friend const_iterator operator+(difference_type offset, const_iterator it) noexcept {
+    return it += offset;
+  }
+  friend const_iterator operator-(const_iterator it, difference_type offset) noexcept {
+    return it -= offset;
+  }
+  friend difference_type operator-(const const_iterator& a, const const_iterator& b) noexcept {
+    return static_cast<difference_type>(a.index_) - static_cast<difference_type>(b.index_);
+  }
+
+  friend bool operator==(const const_iterator& a, const const_iterator& b) noexcept {
+    return a.index_ == b.index_;
+  }
+  friend bool operator!=(const const_iterator& a, const const_iterator& b) noexcept {
+    return a.index_ != b.index_;
+  }
+  friend bool operator<(const const_iterator& a, const const_iterator& b) noexcept {
+    return a.index_ < b.index_;
+  }
+  friend bool operator>(const const_iterator& a, const const_iterator& b) noexcept {
+    return a.index_ > b.index_;
+  }
+  friend bool operator<=(const const_iterator& a, const const_iterator& b) noexcept {
+    return a.index_ <= b.index_;
+  }
+  friend bool operator>=(const const_iterator& a, const const_iterator& b) noexcept {
+    return a.index_ >= b.index_;
+  }
+};
+
+#endif  // INCREMENTAL_SBOVECTOR_HPP
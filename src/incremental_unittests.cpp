@@ -0,0 +1,171 @@
+#include "unittest_common.hpp"
+
+#include "incremental_sbovector.hpp"
+
+// Unittests for IncrementalSBOVector (incremental external growth)
+
+constexpr size_t MIGRATION_CHUNK = 4;
+
+struct DataTypeOperationTrackingIncrementalSBOVector : public DataTypeOperationTrackingSBOVector {
+  using IncrementalContainerType =
+      IncrementalSBOVector<DataType, SBO_SIZE, AllocatorType, MIGRATION_CHUNK>;
+
+  template <typename Container>
+  void UseIndexed(const Container& container) {
+    for (size_t i = 0; i < container.size(); ++i) {
+      container[i].Use();
+    }
+  }
+};
+
+TEST_F(DataTypeOperationTrackingIncrementalSBOVector, MustBoundMovesPerPushBack) {
+  IncrementalContainerType container(create_allocator());
+  auto saw_growing = false;
+  for (size_t i = 0; i < LARGE_SIZE; ++i) {
+    const auto moves = OperationCounter::TOTALS.moves();
+    container.push_back(DataType());
+    const auto moved = static_cast<size_t>(OperationCounter::TOTALS.moves() - moves);
+    // the appended temporary, then the inline spill relocates SBO_SIZE at once and every
+    // later append at most a chunk
+    EXPECT_LE(moved, 1 + (i == SBO_SIZE ? SBO_SIZE : MIGRATION_CHUNK));
+    saw_growing |= container.growing();
+    UseIndexed(container);
+  }
+  EXPECT_TRUE(saw_growing);
+}
+
+TEST_F(DataTypeOperationTrackingIncrementalSBOVector, MustFreeOldBufferWhenMigrated) {
+  IncrementalContainerType container(create_allocator());
+  while (!container.growing()) {
+    container.push_back(DataType());
+  }
+  const auto frees = totals_.frees_;
+  while (container.growing()) {
+    container.push_back(DataType());
+  }
+  EXPECT_EQ(totals_.frees_, frees + 1);
+  EXPECT_EQ(totals_.allocs_, totals_.frees_ + 1);
+  UseElements(container);
+}
+
+TEST_F(DataTypeOperationTrackingIncrementalSBOVector, MustFinishGrowthOnData) {
+  IncrementalContainerType container(create_allocator());
+  while (!container.growing()) {
+    container.push_back(DataType());
+  }
+  const auto size = container.size();
+  auto data = container.data();
+  EXPECT_FALSE(container.growing());
+  EXPECT_EQ(container.size(), size);
+  for (size_t i = 0; i < size; ++i) {
+    EXPECT_EQ(&container[i], data + i);
+  }
+  UseElements(container);
+}
+
+TEST_F(DataTypeOperationTrackingIncrementalSBOVector, MustCopyAndMoveWhileGrowing) {
+  IncrementalContainerType container(create_allocator());
+  while (!container.growing()) {
+    container.push_back(DataType());
+  }
+  container.push_back(DataType());
+  const auto size = container.size();
+  IncrementalContainerType copy(container);
+  EXPECT_FALSE(copy.growing());
+  EXPECT_EQ(copy.capacity(), size);
+  IncrementalContainerType moved(std::move(container));
+  EXPECT_TRUE(moved.growing());
+  EXPECT_TRUE(container.empty());
+  EXPECT_EQ(moved.size(), size);
+  UseIndexed(copy);
+  UseIndexed(moved);
+  copy = moved;
+  EXPECT_EQ(copy.size(), size);
+  UseElements(copy);
+}
+
+TEST_F(DataTypeOperationTrackingIncrementalSBOVector, MustIterateConstWhileGrowing) {
+  IncrementalContainerType container(create_allocator());
+  while (!container.growing()) {
+    container.push_back(DataType());
+  }
+  container.push_back(DataType());
+  const auto size = container.size();
+  // the transition is taken over, no element moves
+  const auto moves = OperationCounter::TOTALS.moves();
+  const IncrementalContainerType moved(std::move(container));
+  EXPECT_EQ(OperationCounter::TOTALS.moves(), moves);
+  EXPECT_TRUE(moved.growing());
+  EXPECT_EQ(moved.end() - moved.begin(), static_cast<ptrdiff_t>(size));
+  size_t index = 0;
+  for (auto iter = moved.cbegin(); iter != moved.cend(); ++iter, ++index) {
+    EXPECT_EQ(&*iter, &moved[index]);
+  }
+  EXPECT_EQ(index, size);
+  UseElements(moved);
+  EXPECT_TRUE(moved.growing());
+}
+
+TEST_F(DataTypeOperationTrackingIncrementalSBOVector, MustPopBackWhileGrowing) {
+  IncrementalContainerType container(create_allocator());
+  while (!container.growing()) {
+    container.push_back(DataType());
+  }
+  container.push_back(DataType());
+  while (container.growing()) {
+    container.pop_back();
+  }
+  UseIndexed(container);
+  while (!container.empty()) {
+    container.pop_back();
+  }
+}
+
+TEST_F(DataTypeOperationTrackingIncrementalSBOVector, MustClearWhileGrowing) {
+  IncrementalContainerType container(create_allocator());
+  while (!container.growing()) {
+    container.push_back(DataType());
+  }
+  container.clear();
+  EXPECT_TRUE(container.empty());
+  EXPECT_FALSE(container.growing());
+  EXPECT_EQ(container.capacity(), SBO_SIZE);
+  EXPECT_EQ(totals_.allocs_, totals_.frees_);
+}
+
+TEST(ValueVerifiedIncrementalSBOVector, MustKeepValuesWhileGrowing) {
+  IncrementalSBOVector<int, SBO_SIZE, std::allocator<int>, 2> container;
+  for (auto i = 0; i < static_cast<int>(LARGE_SIZE); ++i) {
+    container.push_back(i);
+    for (auto j = 0; j <= i; ++j) {
+      ASSERT_EQ(container[static_cast<size_t>(j)], j);
+    }
+  }
+  EXPECT_RANGE_EQ(container, make_vector_sequence<LARGE_SIZE>());
+}
+
+TEST(ValueVerifiedIncrementalSBOVector, MustPushBackOwnElementWhileGrowing) {
+  IncrementalSBOVector<int, SMALL_SIZE, std::allocator<int>, 1> container;
+  std::vector<int> expected;
+  for (auto i = 0; i < static_cast<int>(LARGE_SIZE); ++i) {
+    const auto& first = container.empty() ? i : container[0];
+    expected.push_back(first);
+    container.push_back(first);
+  }
+  EXPECT_RANGE_EQ(container, expected);
+}
+
+TEST(ValueVerifiedIncrementalSBOVector, MustSwapInlineAndExternal) {
+  const auto small = make_vector_sequence<SMALL_SIZE>();
+  const auto large = make_vector_sequence<LARGE_SIZE>();
+  IncrementalSBOVector<int, SBO_SIZE> a, b;
+  for (auto value : small) {
+    a.push_back(value);
+  }
+  for (auto value : large) {
+    b.push_back(value);
+  }
+  a.swap(b);
+  EXPECT_RANGE_EQ(a, large);
+  EXPECT_RANGE_EQ(b, small);
+}
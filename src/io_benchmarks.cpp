@@ -0,0 +1,146 @@
+#include "benchmark_common.hpp"
+
+#include "sbovector.hpp"
+
+#if defined(__unix__)
+
+#include "sbovector_io.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Streams a local file through a pipe: file -> chunk -> pipe -> chunk
+// Staged: read() into a stack buffer then insert() into SBOVector<char, 4096> (copy per hop)
+// Direct: append_from_fd/write_to_fd straight in and out of the SBOVector storage
+
+namespace {
+
+constexpr size_t kChunkBytes = 4096;
+using Chunk = SBOVector<char, kChunkBytes>;
+
+class LocalFile {
+  std::string path_;
+  size_t size_;
+
+ public:
+  explicit LocalFile(size_t megabytes) : size_(megabytes << 20) {
+    path_ = "/tmp/sbovector_io_" + std::to_string(getpid()) + ".bin";
+    const auto fd = open(path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    std::vector<char> block(1 << 20);
+    for (size_t i = 0; i < block.size(); ++i) {
+      block[i] = static_cast<char>(i * 31);
+    }
+    for (size_t i = 0; i < megabytes && fd >= 0; ++i) {
+      if (write(fd, block.data(), block.size()) != static_cast<ssize_t>(block.size())) {
+        size_ = 0;
+        break;
+      }
+    }
+    if (fd >= 0) {
+      close(fd);
+    } else {
+      size_ = 0;
+    }
+  }
+  ~LocalFile() { unlink(path_.c_str()); }
+
+  const char* path() const { return path_.c_str(); }
+  size_t size() const { return size_; }
+};
+
+const LocalFile& GetLocalFile() {
+  static LocalFile file(256);
+  return file;
+}
+
+ssize_t StagedAppend(Chunk& chunk, int fd, size_t max_bytes) {
+  char buffer[kChunkBytes * 4];
+  ssize_t result;
+  do {
+    result = read(fd, buffer, std::min(max_bytes, sizeof(buffer)));
+  } while (result < 0 && errno == EINTR);
+  if (result > 0) {
+    chunk.insert(chunk.end(), buffer, buffer + result);
+  }
+  return result;
+}
+
+ssize_t StagedWrite(int fd, const Chunk& chunk) {
+  size_t written = 0;
+  while (written < chunk.size()) {
+    const auto result = write(fd, chunk.data() + written, chunk.size() - written);
+    if (result < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return -1;
+    }
+    written += static_cast<size_t>(result);
+  }
+  return static_cast<ssize_t>(written);
+}
+
+template <typename Append, typename Write>
+void RunStream(benchmark::State& state, Append&& append, Write&& write_chunk) {
+  const auto& file = GetLocalFile();
+  const auto read_bytes = static_cast<size_t>(state.range(0));
+  if (file.size() == 0) {
+    state.SkipWithError("unable to create the local file");
+    return;
+  }
+  for (auto _ : state) {
+    int fds[2];
+    const auto in = open(file.path(), O_RDONLY);
+    if (in < 0 || pipe(fds) != 0) {
+      state.SkipWithError("unable to open the local file/pipe");
+      return;
+    }
+    std::thread producer([&]() {
+      Chunk chunk;
+      while (append(chunk, in, read_bytes) > 0) {
+        write_chunk(fds[1], chunk);
+        chunk.clear();
+      }
+      close(fds[1]);
+    });
+    Chunk chunk;
+    size_t received = 0;
+    while (append(chunk, fds[0], read_bytes) > 0) {
+      received += chunk.size();
+      chunk.clear();
+    }
+    producer.join();
+    close(fds[0]);
+    close(in);
+    benchmark::DoNotOptimize(received);
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(file.size()));
+}
+
+}  // namespace
+
+static void BM_StreamFileStaged(benchmark::State& state) {
+  RunStream(state, StagedAppend, StagedWrite);
+}
+
+static void BM_StreamFileDirect(benchmark::State& state) {
+  RunStream(
+    state,
+    [](Chunk& chunk, int fd, size_t max_bytes) { return append_from_fd(chunk, fd, max_bytes); },
+    [](int fd, const Chunk& chunk) { return write_to_fd(fd, chunk); }
+  );
+}
+
+// read sizes: inline chunk, 4 chunks (Staged spills the chunk, Direct fills the inline chunk
+// first and reads at most that much) (real time as the work spans two threads)
+BENCHMARK(BM_StreamFileStaged)->Arg(kChunkBytes)->Arg(kChunkBytes * 4)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_StreamFileDirect)->Arg(kChunkBytes)->Arg(kChunkBytes * 4)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+
+#endif  // defined(__unix__)
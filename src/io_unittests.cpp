@@ -0,0 +1,141 @@
+#include "unittest_common.hpp"
+
+#if defined(__unix__)
+
+#include "sbovector_io.hpp"
+
+#include <pthread.h>
+#include <signal.h>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+// Unittests for file descriptor I/O (append_from_fd/write_to_fd)
+
+namespace {
+
+struct Pipe {
+  int read_ = -1;
+  int write_ = -1;
+  Pipe() {
+    int fds[2];
+    EXPECT_EQ(pipe(fds), 0);
+    read_ = fds[0];
+    write_ = fds[1];
+  }
+  ~Pipe() {
+    close_write();
+    if (read_ >= 0) {
+      close(read_);
+    }
+  }
+  void close_write() {
+    if (write_ >= 0) {
+      close(write_);
+      write_ = -1;
+    }
+  }
+};
+
+template <size_t Size>
+SBOVector<char, Size> MakeBytes(size_t count, char first) {
+  SBOVector<char, Size> out;
+  for (auto i = 0u; i < count; ++i) {
+    out.push_back(static_cast<char>(first + static_cast<char>(i % 26)));
+  }
+  return out;
+}
+
+// reads fd until end of file
+std::string ReadAll(int fd) {
+  SBOVector<char, SBO_SIZE> out;
+  while (append_from_fd(out, fd, 4096) > 0) {
+  }
+  return std::string(out.begin(), out.end());
+}
+
+void NoOpHandler(int) {}
+
+}  // namespace
+
+TEST(ValueVerifiedSBOVector, MustAppendFromFd) {
+  Pipe p;
+  const auto bytes = MakeBytes<SBO_SIZE>(LARGE_SIZE, 'a');
+  ASSERT_EQ(write(p.write_, bytes.data(), bytes.size()), static_cast<ssize_t>(LARGE_SIZE));
+  p.close_write();
+
+  SBOVector<char, SBO_SIZE> sbo(SMALL_SIZE, 'x');
+  // the free inline capacity is filled first, without spilling
+  const auto spare = SBO_SIZE - SMALL_SIZE;
+  EXPECT_EQ(append_from_fd(sbo, p.read_, LARGE_SIZE * 2), static_cast<ssize_t>(spare));
+  EXPECT_EQ(sbo.size(), SBO_SIZE);
+  EXPECT_EQ(sbo.capacity(), SBO_SIZE);
+  // partial read: less available than requested
+  EXPECT_EQ(append_from_fd(sbo, p.read_, LARGE_SIZE * 2),
+            static_cast<ssize_t>(LARGE_SIZE - spare));
+  EXPECT_EQ(sbo.size(), SMALL_SIZE + LARGE_SIZE);
+  EXPECT_EQ(std::string(sbo.begin() + SMALL_SIZE, sbo.end()), std::string(bytes.begin(), bytes.end()));
+  // end of file leaves the vector unchanged
+  EXPECT_EQ(append_from_fd(sbo, p.read_, LARGE_SIZE), 0);
+  EXPECT_EQ(sbo.size(), SMALL_SIZE + LARGE_SIZE);
+}
+
+TEST(ValueVerifiedSBOVector, MustAppendFromFdError) {
+  SBOVector<char, SBO_SIZE> sbo(SMALL_SIZE, 'x');
+  EXPECT_EQ(append_from_fd(sbo, -1, LARGE_SIZE), -1);
+  EXPECT_EQ(errno, EBADF);
+  EXPECT_EQ(sbo.size(), SMALL_SIZE);
+  EXPECT_EQ(sbo.capacity(), SBO_SIZE);
+}
+
+TEST(ValueVerifiedSBOVector, MustRetryAppendFromFdOnEINTR) {
+  struct sigaction action {}, previous {};
+  action.sa_handler = NoOpHandler;  // no SA_RESTART: read() fails with EINTR
+  sigemptyset(&action.sa_mask);
+  ASSERT_EQ(sigaction(SIGUSR1, &action, &previous), 0);
+
+  Pipe p;
+  SBOVector<char, SBO_SIZE> sbo;
+  ssize_t result = 0;
+  std::thread reader([&]() { result = append_from_fd(sbo, p.read_, LARGE_SIZE); });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  pthread_kill(reader.native_handle(), SIGUSR1);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  ASSERT_EQ(write(p.write_, "abc", 3), 3);
+  reader.join();
+  EXPECT_EQ(result, 3);
+  EXPECT_EQ(std::string(sbo.begin(), sbo.end()), "abc");
+  sigaction(SIGUSR1, &previous, nullptr);
+}
+
+TEST(ValueVerifiedSBOVector, MustWriteToFd) {
+  Pipe p;
+  const auto a = MakeBytes<SBO_SIZE>(SMALL_SIZE, 'a');
+  const auto b = MakeBytes<SBO_SIZE>(0, 'b');
+  const auto c = MakeBytes<SMALL_SIZE>(LARGE_SIZE, 'c');
+  EXPECT_EQ(write_to_fd(p.write_, a, b, c), static_cast<ssize_t>(SMALL_SIZE + LARGE_SIZE));
+  p.close_write();
+  EXPECT_EQ(ReadAll(p.read_), std::string(a.begin(), a.end()) + std::string(c.begin(), c.end()));
+}
+
+TEST(ValueVerifiedSBOVector, MustWriteRangeToFdPartially) {
+  // more vectors than IOV_MAX and more bytes than the pipe buffer:
+  // forces batching and partial writes while the reader drains the pipe
+  Pipe p;
+  std::vector<SBOVector<char, SBO_SIZE>> messages;
+  std::string expected;
+  for (auto i = 0u; i < 3000; ++i) {
+    messages.push_back(MakeBytes<SBO_SIZE>(i % 2 ? SMALL_SIZE : LARGE_SIZE, 'a'));
+    expected.append(messages.back().begin(), messages.back().end());
+  }
+  std::string received;
+  std::thread reader([&]() { received = ReadAll(p.read_); });
+  EXPECT_EQ(write_range_to_fd(p.write_, messages.begin(), messages.end()),
+            static_cast<ssize_t>(expected.size()));
+  p.close_write();
+  reader.join();
+  EXPECT_EQ(received, expected);
+}
+
+#endif  // defined(__unix__)
@@ -0,0 +1,295 @@
+#include "benchmark_common.hpp"
+
+#include "incremental_sbovector.hpp"
+#include "sbovector.hpp"
+#include "slab_allocator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+// Per operation latency percentiles, for the growth spikes mean throughput hides
+//
+// Every push_back / insert / erase / swap is timed on its own (rdtsc on x86, assumed invariant,
+// clock_gettime(CLOCK_MONOTONIC) elsewhere; the timer's own overhead is subtracted) into a log
+// linear histogram (HDR style, < 1% error), reported as p50_ns, p99_ns, p999_ns and max_ns.
+// range(0) is the size each iteration grows to (or starts from), chosen around the growth
+// boundaries: 16 (inline), 17 (one spill), 256 and 4096 (spill then 4 / 8 reallocations).
+// Containers: std::vector and SBOVector<T, 16> with std::allocator (Std) or a SlabAllocator
+// over an arena created per iteration (Slab). push_back also runs up to 4M ints against
+// IncrementalSBOVector, whose max_ns stays bounded where the others stall to relocate, eg:
+//   latency_benchmarks --benchmark_filter='PushBack<SBO16Std<Pod64>>'
+
+namespace {
+
+struct Pod64 {
+  int64_t values_[8];
+};
+static_assert(sizeof(Pod64) == 64 && std::is_trivial_v<Pod64>);
+
+// Timer
+
+#if defined(__x86_64__) || defined(__i386__)
+inline uint64_t Ticks() {
+  _mm_lfence();
+  const auto ticks = __rdtsc();
+  _mm_lfence();
+  return ticks;
+}
+#else
+inline uint64_t Ticks() {
+  timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return static_cast<uint64_t>(now.tv_sec) * 1000000000u + static_cast<uint64_t>(now.tv_nsec);
+}
+#endif
+
+struct TimerCalibration {
+  double ns_per_tick_;
+  uint64_t overhead_ticks_;
+};
+
+const TimerCalibration& GetCalibration() {
+  static const auto calibration = []() {
+    using Clock = std::chrono::steady_clock;
+    const auto start = Clock::now();
+    const auto start_ticks = Ticks();
+    while (Clock::now() - start < std::chrono::milliseconds(20)) {
+    }
+    const auto end_ticks = Ticks();
+    const auto elapsed = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    auto overhead = ~uint64_t{0};
+    for (int i = 0; i < 10000; ++i) {
+      const auto before = Ticks();
+      overhead = std::min(overhead, Ticks() - before);
+    }
+    return TimerCalibration{elapsed / static_cast<double>(end_ticks - start_ticks), overhead};
+  }();
+  return calibration;
+}
+
+// Log linear histogram of tick counts: exact below 128, then 64 buckets per power of two
+class LatencyHistogram {
+  static constexpr size_t kLinear = 128;
+  static constexpr size_t kPerPowerOfTwo = 64;
+  static constexpr size_t kBuckets = kLinear + (64 - 7) * kPerPowerOfTwo;
+
+  std::array<uint64_t, kBuckets> counts_{};
+  uint64_t total_ = 0;
+  uint64_t max_ = 0;
+
+  static size_t Index(uint64_t value) {
+    if (value < kLinear) {
+      return value;
+    }
+    size_t shift = 0;
+    while ((value >> shift) >= kLinear) {
+      ++shift;
+    }
+    // value >> shift in [64, 128)
+    return kLinear + (shift - 1) * kPerPowerOfTwo + ((value >> shift) - 64);
+  }
+
+  // highest value of the bucket
+  static uint64_t UpperBound(size_t index) {
+    if (index < kLinear) {
+      return index;
+    }
+    const auto shift = (index - kLinear) / kPerPowerOfTwo + 1;
+    const auto lower = uint64_t{(index - kLinear) % kPerPowerOfTwo + 64} << shift;
+    return lower + (uint64_t{1} << shift) - 1;
+  }
+
+ public:
+  void Record(uint64_t value) {
+    ++counts_[Index(value)];
+    ++total_;
+    max_ = std::max(max_, value);
+  }
+
+  [[nodiscard]] uint64_t Percentile(double percentile) const {
+    const auto rank = static_cast<uint64_t>(percentile * static_cast<double>(total_) + 0.5);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+      seen += counts_[i];
+      if (seen >= std::max<uint64_t>(rank, 1)) {
+        return std::min(UpperBound(i), max_);
+      }
+    }
+    return max_;
+  }
+
+  void Report(benchmark::State& state) const {
+    const auto& calibration = GetCalibration();
+    const auto ns = [&](uint64_t ticks) {
+      return static_cast<double>(ticks) * calibration.ns_per_tick_;
+    };
+    state.counters["p50_ns"] = ns(Percentile(0.5));
+    state.counters["p99_ns"] = ns(Percentile(0.99));
+    state.counters["p999_ns"] = ns(Percentile(0.999));
+    state.counters["max_ns"] = ns(max_);
+  }
+};
+
+// times one operation, less the timer overhead
+template <typename Operation>
+inline void Time(LatencyHistogram& histogram, Operation&& operation) {
+  const auto overhead = GetCalibration().overhead_ticks_;
+  const auto before = Ticks();
+  operation();
+  const auto elapsed = Ticks() - before;
+  histogram.Record(elapsed > overhead ? elapsed - overhead : 0);
+}
+
+// Containers, made from the iteration's arena
+
+template <typename T>
+struct StdVectorStd {
+  using DataType = T;
+  using Vector = std::vector<T>;
+  static Vector Make(SlabArena&) { return Vector(); }
+};
+
+template <typename T>
+struct StdVectorSlab {
+  using DataType = T;
+  using Vector = std::vector<T, SlabAllocator<T>>;
+  static Vector Make(SlabArena& arena) { return Vector(SlabAllocator<T>(arena)); }
+};
+
+template <typename T>
+struct SBO16Std {
+  using DataType = T;
+  using Vector = SBOVector<T, 16>;
+  static Vector Make(SlabArena&) { return Vector(); }
+};
+
+template <typename T>
+struct SBO16Slab {
+  using DataType = T;
+  using Vector = SBOVector<T, 16, SlabAllocator<T>>;
+  static Vector Make(SlabArena& arena) { return Vector(SlabAllocator<T>(arena)); }
+};
+
+template <typename T>
+struct IncrementalSBO16Std {
+  using DataType = T;
+  using Vector = IncrementalSBOVector<T, 16>;
+  static Vector Make(SlabArena&) { return Vector(); }
+};
+
+template <typename Container>
+void BM_PushBack(benchmark::State& state) {
+  GetCalibration();
+  const auto count = static_cast<size_t>(state.range(0));
+  const typename Container::DataType value{};
+  LatencyHistogram histogram;
+  for (auto _ : state) {
+    auto arena = std::make_unique<SlabArena>();
+    auto c = Container::Make(*arena);
+    for (size_t i = 0; i < count; ++i) {
+      Time(histogram, [&]() { c.push_back(value); });
+    }
+    benchmark::DoNotOptimize(c.data());
+  }
+  histogram.Report(state);
+}
+
+template <typename Container>
+void BM_InsertFront(benchmark::State& state) {
+  GetCalibration();
+  const auto count = static_cast<size_t>(state.range(0));
+  const typename Container::DataType value{};
+  LatencyHistogram histogram;
+  for (auto _ : state) {
+    auto arena = std::make_unique<SlabArena>();
+    auto c = Container::Make(*arena);
+    for (size_t i = 0; i < count; ++i) {
+      Time(histogram, [&]() { c.insert(c.begin(), value); });
+    }
+    benchmark::DoNotOptimize(c.data());
+  }
+  histogram.Report(state);
+}
+
+template <typename Container>
+void BM_EraseFront(benchmark::State& state) {
+  GetCalibration();
+  const auto count = static_cast<size_t>(state.range(0));
+  const typename Container::DataType value{};
+  LatencyHistogram histogram;
+  for (auto _ : state) {
+    auto arena = std::make_unique<SlabArena>();
+    auto c = Container::Make(*arena);
+    for (size_t i = 0; i < count; ++i) {
+      c.push_back(value);
+    }
+    for (size_t i = 0; i < count; ++i) {
+      Time(histogram, [&]() { c.erase(c.begin()); });
+    }
+    benchmark::DoNotOptimize(c.data());
+  }
+  histogram.Report(state);
+}
+
+// with an 8 element (inline) container: exchanges of inline and spilled storage
+template <typename Container>
+void BM_Swap(benchmark::State& state) {
+  GetCalibration();
+  const auto count = static_cast<size_t>(state.range(0));
+  const typename Container::DataType value{};
+  LatencyHistogram histogram;
+  for (auto _ : state) {
+    auto arena = std::make_unique<SlabArena>();
+    auto a = Container::Make(*arena);
+    auto b = Container::Make(*arena);
+    for (size_t i = 0; i < count; ++i) {
+      a.push_back(value);
+    }
+    for (size_t i = 0; i < 8; ++i) {
+      b.push_back(value);
+    }
+    for (size_t i = 0; i < 64; ++i) {
+      Time(histogram, [&]() { a.swap(b); });
+    }
+    benchmark::DoNotOptimize(a.data());
+  }
+  histogram.Report(state);
+}
+
+}  // namespace
+
+#define LATENCY_SIZES ->Arg(16)->Arg(17)->Arg(256)->Arg(4096)
+
+#define LATENCY_CONTAINER_BENCHMARKS(NAME, ELEMENT) \
+  BENCHMARK_TEMPLATE(NAME, StdVectorStd<ELEMENT>) LATENCY_SIZES; \
+  BENCHMARK_TEMPLATE(NAME, StdVectorSlab<ELEMENT>) LATENCY_SIZES; \
+  BENCHMARK_TEMPLATE(NAME, SBO16Std<ELEMENT>) LATENCY_SIZES; \
+  BENCHMARK_TEMPLATE(NAME, SBO16Slab<ELEMENT>) LATENCY_SIZES
+
+#define LATENCY_BENCHMARKS(NAME) \
+  LATENCY_CONTAINER_BENCHMARKS(NAME, int); \
+  LATENCY_CONTAINER_BENCHMARKS(NAME, Pod64)
+
+LATENCY_BENCHMARKS(BM_PushBack);
+// the relocation stall of a large vector against IncrementalSBOVector's bounded migration
+#define LATENCY_LARGE_SIZES ->Arg(1 << 18)->Arg(1 << 22)->Unit(benchmark::kMillisecond)
+BENCHMARK_TEMPLATE(BM_PushBack, StdVectorStd<int>) LATENCY_LARGE_SIZES;
+BENCHMARK_TEMPLATE(BM_PushBack, SBO16Std<int>) LATENCY_LARGE_SIZES;
+BENCHMARK_TEMPLATE(BM_PushBack, IncrementalSBO16Std<int>) LATENCY_LARGE_SIZES;
+BENCHMARK_TEMPLATE(BM_PushBack, IncrementalSBO16Std<int>) LATENCY_SIZES;
+LATENCY_BENCHMARKS(BM_InsertFront);
+LATENCY_BENCHMARKS(BM_EraseFront);
+LATENCY_BENCHMARKS(BM_Swap);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,311 @@
+#include "benchmark_common.hpp"
+
+#include "sbovector.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Workloads shaped like our uses of small vectors, rather than one operation in a loop
+//   GraphBFS: BFS over a power law graph, adjacency as std::vector<Vector<uint32_t>>
+//   Tokenize: a document split into one Vector<std::string_view> of tokens per line
+//   GroupBy: Zipf keyed records grouped into one Vector<uint32_t> bucket per key, then
+//            a histogram of each bucket
+//   MessageBatching: messages batched per connection in a Vector<Message>, flushed when full
+//            or every tick
+// each for std::vector (Std) and SBOVector at BufferSizes around the workload's typical
+// size (4 below, 8 about the median, 16 above), reporting items/s and the memory of the
+// structures built: RSS growth (rss_MB, peak_rss_MB: noisy, the heap may reuse memory freed
+// by earlier benchmarks) and the peak heap bytes they allocated (peak_bytes: exact). Rebuilt
+// or reused structures also report per iteration allocs (see ScopedAllocationCounters).
+// Inputs are generated once from fixed seeds.
+
+namespace {
+
+struct Std {
+  template <typename T>
+  using Vector = std::vector<T, BenchmarkCountingAllocator<T>>;
+};
+
+template <size_t BufferSize>
+struct SBO {
+  template <typename T>
+  using Vector = SBOVector<T, BufferSize, BenchmarkCountingAllocator<T>>;
+};
+
+// the collection of small vectors
+template <typename T>
+using Outer = std::vector<T, BenchmarkCountingAllocator<T>>;
+
+// Pareto distributed in [min, max], P(x > k) ~ (k / min)^-(alpha - 1)
+size_t PowerLaw(std::mt19937& random, double alpha, size_t min, size_t max) {
+  std::uniform_real_distribution<double> uniform(std::nextafter(0.0, 1.0), 1.0);
+  const auto x = static_cast<double>(min) * std::pow(uniform(random), -1.0 / (alpha - 1.0));
+  return std::min(max, static_cast<size_t>(x));
+}
+
+// GraphBFS
+
+constexpr uint32_t kGraphVertices = 1 << 18;
+
+// out degrees: power law from 2 (median ~4, mean ~12, a few hubs in the thousands)
+const std::vector<std::vector<uint32_t>>& GetEdgeLists() {
+  static const auto edges = []() {
+    std::mt19937 random(42);
+    std::uniform_int_distribution<uint32_t> vertex(0, kGraphVertices - 1);
+    std::vector<std::vector<uint32_t>> out(kGraphVertices);
+    for (auto& targets : out) {
+      targets.resize(PowerLaw(random, 2.1, 2, 4096));
+      for (auto& target : targets) {
+        target = vertex(random);
+      }
+    }
+    return out;
+  }();
+  return edges;
+}
+
+template <typename Policy>
+void BM_GraphBFS(benchmark::State& state) {
+  using Adjacency = Outer<typename Policy::template Vector<uint32_t>>;
+  const auto& edges = GetEdgeLists();
+  rss::ReleaseFreeMemory();
+  ScopedRSSCounters rss_counters;
+  ScopedAllocationCounters allocation_counters(state);
+  Adjacency graph(kGraphVertices);
+  for (uint32_t v = 0; v < kGraphVertices; ++v) {
+    for (auto target : edges[v]) {
+      graph[v].push_back(target);
+    }
+  }
+  rss_counters.Report(state);
+  // built once: no per iteration allocs
+  state.counters["peak_bytes"] = static_cast<double>(allocation_counters.PeakBytes());
+
+  std::vector<uint32_t> frontier, next;
+  std::vector<uint8_t> visited(kGraphVertices);
+  int64_t edges_visited = 0;
+  for (auto _ : state) {
+    std::fill(visited.begin(), visited.end(), uint8_t{0});
+    frontier.assign(1, 0);
+    visited[0] = 1;
+    while (!frontier.empty()) {
+      next.clear();
+      for (auto v : frontier) {
+        for (auto target : graph[v]) {
+          if (!visited[target]) {
+            visited[target] = 1;
+            next.push_back(target);
+          }
+        }
+        edges_visited += static_cast<int64_t>(graph[v].size());
+      }
+      frontier.swap(next);
+    }
+  }
+  state.SetItemsProcessed(edges_visited);
+}
+
+// Tokenize
+
+constexpr size_t kDocumentLines = 1 << 16;
+
+// words per line: power law from 3 (median ~5), words of 1 to 10 letters
+const std::string& GetDocument() {
+  static const auto document = []() {
+    std::mt19937 random(7);
+    std::uniform_int_distribution<int> letter('a', 'z');
+    std::uniform_int_distribution<size_t> word_length(1, 10);
+    std::string out;
+    for (size_t line = 0; line < kDocumentLines; ++line) {
+      const auto words = PowerLaw(random, 2.5, 3, 200);
+      for (size_t word = 0; word < words; ++word) {
+        out.append(word ? 1 : 0, ' ');
+        const auto length = word_length(random);
+        for (size_t i = 0; i < length; ++i) {
+          out.push_back(static_cast<char>(letter(random)));
+        }
+      }
+      out.push_back('\n');
+    }
+    return out;
+  }();
+  return document;
+}
+
+template <typename Policy>
+void BM_Tokenize(benchmark::State& state) {
+  using Tokens = typename Policy::template Vector<std::string_view>;
+  const std::string_view document = GetDocument();
+  rss::ReleaseFreeMemory();
+  ScopedRSSCounters rss_counters;
+  ScopedAllocationCounters allocation_counters(state);
+  Outer<Tokens> lines;
+  lines.reserve(kDocumentLines);
+  for (auto _ : state) {
+    lines.clear();
+    size_t begin = 0;
+    while (begin < document.size()) {
+      const auto end = document.find('\n', begin);
+      lines.emplace_back();
+      auto& tokens = lines.back();
+      for (auto word = begin; word < end;) {
+        const auto space = std::min(document.find(' ', word), end);
+        tokens.push_back(document.substr(word, space - word));
+        word = space + 1;
+      }
+      begin = end + 1;
+    }
+    benchmark::DoNotOptimize(lines.data());
+  }
+  rss_counters.Report(state);
+  allocation_counters.Report(state);
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(document.size()));
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kDocumentLines));
+}
+
+// GroupBy
+
+constexpr uint32_t kGroupKeys = 1 << 15;
+
+struct Record {
+  uint32_t key_;
+  uint32_t value_;
+};
+
+// records per key: power law from 3 (median ~6, a few keys with thousands), shuffled
+const std::vector<Record>& GetRecords() {
+  static const auto records = []() {
+    std::mt19937 random(11);
+    std::vector<Record> out;
+    for (uint32_t key = 0; key < kGroupKeys; ++key) {
+      const auto count = PowerLaw(random, 2.0, 3, 8192);
+      for (size_t i = 0; i < count; ++i) {
+        out.push_back({key, static_cast<uint32_t>(random() % 1000)});
+      }
+    }
+    std::shuffle(out.begin(), out.end(), random);
+    return out;
+  }();
+  return records;
+}
+
+template <typename Policy>
+void BM_GroupBy(benchmark::State& state) {
+  using Bucket = typename Policy::template Vector<uint32_t>;
+  const auto& records = GetRecords();
+  rss::ReleaseFreeMemory();
+  ScopedRSSCounters rss_counters;
+  ScopedAllocationCounters allocation_counters(state);
+  for (auto _ : state) {
+    Outer<Bucket> buckets(kGroupKeys);
+    for (const auto& record : records) {
+      buckets[record.key_].push_back(record.value_);
+    }
+    // 10 bins of 100 per group
+    uint64_t checksum = 0;
+    for (const auto& bucket : buckets) {
+      uint32_t bins[10] = {};
+      for (auto value : bucket) {
+        ++bins[value / 100];
+      }
+      checksum += *std::max_element(std::begin(bins), std::end(bins));
+    }
+    benchmark::DoNotOptimize(checksum);
+    state.PauseTiming();
+    rss_counters.Report(state);
+    buckets = {};
+    state.ResumeTiming();
+  }
+  allocation_counters.Report(state);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(records.size()));
+}
+
+// MessageBatching
+
+constexpr uint32_t kConnections = 4096;
+constexpr size_t kMessages = 1 << 20;
+constexpr size_t kBatchLimit = 8;
+constexpr size_t kTickMessages = 16384;
+
+struct Message {
+  uint32_t connection_;
+  uint32_t length_;
+  uint64_t sequence_;
+};
+
+// connections by activity: power law (a few chatty, most idle between ticks)
+const std::vector<Message>& GetMessages() {
+  static const auto messages = []() {
+    std::mt19937 random(5);
+    std::vector<Message> out(kMessages);
+    uint64_t sequence = 0;
+    for (auto& message : out) {
+      const auto rank = static_cast<uint32_t>(PowerLaw(random, 1.5, 1, kConnections) - 1);
+      message.connection_ = static_cast<uint32_t>((uint64_t{rank} * 2654435761u) % kConnections);
+      message.length_ = 16 + static_cast<uint32_t>(random() % 240);
+      message.sequence_ = sequence++;
+    }
+    return out;
+  }();
+  return messages;
+}
+
+template <typename Policy>
+void BM_MessageBatching(benchmark::State& state) {
+  using Batch = typename Policy::template Vector<Message>;
+  const auto& messages = GetMessages();
+  rss::ReleaseFreeMemory();
+  ScopedRSSCounters rss_counters;
+  ScopedAllocationCounters allocation_counters(state);
+  Outer<Batch> batches(kConnections);
+  uint64_t bytes_sent = 0;
+  const auto flush = [&](Batch& batch) {
+    for (const auto& message : batch) {
+      bytes_sent += message.length_;
+    }
+    batch.clear();
+  };
+  for (auto _ : state) {
+    size_t until_tick = kTickMessages;
+    for (const auto& message : messages) {
+      auto& batch = batches[message.connection_];
+      batch.push_back(message);
+      if (batch.size() == kBatchLimit) {
+        flush(batch);
+      }
+      if (--until_tick == 0) {
+        for (auto& pending : batches) {
+          flush(pending);
+        }
+        until_tick = kTickMessages;
+      }
+    }
+    for (auto& pending : batches) {
+      flush(pending);
+    }
+  }
+  benchmark::DoNotOptimize(bytes_sent);
+  rss_counters.Report(state);
+  allocation_counters.Report(state);
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kMessages));
+}
+
+}  // namespace
+
+#define MACRO_BENCHMARKS(NAME) \
+  BENCHMARK_TEMPLATE(NAME, Std)->Unit(benchmark::kMillisecond); \
+  BENCHMARK_TEMPLATE(NAME, SBO<4>)->Unit(benchmark::kMillisecond); \
+  BENCHMARK_TEMPLATE(NAME, SBO<8>)->Unit(benchmark::kMillisecond); \
+  BENCHMARK_TEMPLATE(NAME, SBO<16>)->Unit(benchmark::kMillisecond)
+
+MACRO_BENCHMARKS(BM_GraphBFS);
+MACRO_BENCHMARKS(BM_Tokenize);
+MACRO_BENCHMARKS(BM_GroupBy);
+MACRO_BENCHMARKS(BM_MessageBatching);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,171 @@
+#ifndef MMAP_ALLOCATOR_HPP
+#define MMAP_ALLOCATOR_HPP
+
+#if !defined(__linux__)
+#error "MmapAllocator requires Linux (mmap/mremap)"
+#endif
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <memory>
+#include <type_traits>
+
+// Flags for MmapAllocator, combine with |
+enum MmapAllocatorFlags : unsigned {
+  kMmapDefault = 0,
+  // madvise(MADV_HUGEPAGE) every mapping (transparent huge pages, best effort)
+  kMmapHugePages = 1,
+  // pre-fault every mapping (MAP_POPULATE on mmap, MADV_POPULATE_WRITE on mremap growth and
+  // with kMmapHugePages, so the faults happen after the advice and get huge pages)
+  kMmapPopulate = 2,
+};
+
+namespace details_ {
+
+inline size_t MmapPageSize() noexcept {
+  static const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+  return page_size;
+}
+
+inline size_t MmapLength(size_t bytes) noexcept {
+  const auto page_size = MmapPageSize();
+  return (bytes + page_size - 1) / page_size * page_size;
+}
+
+inline void MmapAdvise(void* p, size_t length, unsigned flags) noexcept {
+#ifdef MADV_HUGEPAGE
+  if (flags & kMmapHugePages) {
+    madvise(p, length, MADV_HUGEPAGE);
+  }
+#endif
+  static_cast<void>(p);
+  static_cast<void>(length);
+  static_cast<void>(flags);
+}
+
+// Faults [p, p + length) in for writing: MADV_POPULATE_WRITE (Linux 5.14), else touching a
+// byte per page (read and written back, so contents are kept)
+inline void MmapPrefault(void* p, size_t length) noexcept {
+#ifdef MADV_POPULATE_WRITE
+  if (madvise(p, length, MADV_POPULATE_WRITE) == 0) {
+    return;
+  }
+#endif
+  const auto page_size = MmapPageSize();
+  auto bytes = static_cast<volatile char*>(p);
+  for (size_t offset = 0; offset < length; offset += page_size) {
+    bytes[offset] = bytes[offset];
+  }
+}
+
+}  // namespace details_
+
+// Allocator for huge spilled SBOVectors
+//
+// Allocations of at least ThresholdBytes are anonymous private mappings,
+// anything smaller is served by std::allocator.
+// Provides reallocate() which SBOVector uses (for trivially copyable DataType)
+// to grow mapped buffers with mremap(MREMAP_MAYMOVE) instead of copy + free,
+// so growth never keeps two copies of the contents resident.
+//
+// Stateless: whether a buffer is mapped is decided from its size alone.
+template <
+  typename T,
+  size_t ThresholdBytes = (size_t{1} << 20),
+  unsigned Flags = kMmapDefault
+>
+struct MmapAllocator {
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using size_type = size_t;
+
+  using is_always_equal = std::true_type;
+
+  template <typename U>
+  struct rebind {
+    using other = MmapAllocator<U, ThresholdBytes, Flags>;
+  };
+
+  MmapAllocator() noexcept = default;
+
+  template <typename U>
+  MmapAllocator(const MmapAllocator<U, ThresholdBytes, Flags>&) noexcept {}
+
+  static constexpr bool is_mapped(size_t n) noexcept {
+    return n * sizeof(T) >= ThresholdBytes;
+  }
+
+  pointer allocate(size_t n, const void*) { return allocate(n); }
+  pointer allocate(size_t n) {
+    if (!is_mapped(n)) {
+      return std::allocator<T>().allocate(n);
+    }
+    const auto length = details_::MmapLength(n * sizeof(T));
+    // MAP_POPULATE would fault 4 KiB pages in before MADV_HUGEPAGE: prefault after the advice
+    constexpr bool kPrefaultAfterAdvice = (Flags & kMmapHugePages) && (Flags & kMmapPopulate);
+    int map_flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    if ((Flags & kMmapPopulate) && !kPrefaultAfterAdvice) {
+      map_flags |= MAP_POPULATE;
+    }
+    auto p = mmap(nullptr, length, PROT_READ | PROT_WRITE, map_flags, -1, 0);
+    if (p == MAP_FAILED) {
+      return nullptr;
+    }
+    details_::MmapAdvise(p, length, Flags);
+    if (kPrefaultAfterAdvice) {
+      details_::MmapPrefault(p, length);
+    }
+    return static_cast<pointer>(p);
+  }
+
+  void deallocate(pointer p, size_t n) noexcept {
+    if (!is_mapped(n)) {
+      std::allocator<T>().deallocate(p, n);
+      return;
+    }
+    munmap(p, details_::MmapLength(n * sizeof(T)));
+  }
+
+  // Grows p from old_n to new_n elements (new_n > old_n) keeping the contents,
+  // returns nullptr on failure (p is still valid in that case)
+  pointer reallocate(pointer p, size_t old_n, size_t new_n) noexcept {
+    static_assert(std::is_trivially_copyable_v<T>);
+    if (!is_mapped(new_n) || !is_mapped(old_n)) {
+      auto out = allocate(new_n);
+      if (out) {
+        std::memcpy(out, p, old_n * sizeof(T));
+        deallocate(p, old_n);
+      }
+      return out;
+    }
+
+    const auto old_length = details_::MmapLength(old_n * sizeof(T));
+    const auto new_length = details_::MmapLength(new_n * sizeof(T));
+    if (old_length == new_length) {
+      return p;
+    }
+    auto out = mremap(p, old_length, new_length, MREMAP_MAYMOVE);
+    if (out == MAP_FAILED) {
+      return nullptr;
+    }
+    details_::MmapAdvise(out, new_length, Flags);
+    if (Flags & kMmapPopulate) {
+      details_::MmapPrefault(static_cast<char*>(out) + old_length, new_length - old_length);
+    }
+    return static_cast<pointer>(out);
+  }
+
+  template <typename U>
+  bool operator==(const MmapAllocator<U, ThresholdBytes, Flags>&) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const MmapAllocator<U, ThresholdBytes, Flags>&) const noexcept {
+    return false;
+  }
+};
+
+#endif  // MMAP_ALLOCATOR_HPP
@@ -0,0 +1,97 @@
+#include "unittest_common.hpp"
+
+#if defined(__linux__)
+
+#include "mmap_allocator.hpp"
+
+#include <numeric>
+
+// Unittests for MmapAllocator and SBOVector growth through Allocator::reallocate
+
+// small threshold so the tests cross it with LARGE_SIZE
+constexpr size_t MMAP_THRESHOLD = 256;
+using MmapIntAllocator = MmapAllocator<int, MMAP_THRESHOLD>;
+
+static_assert(details_::has_reallocate_v<MmapIntAllocator>);
+static_assert(!details_::has_reallocate_v<std::allocator<int>>);
+static_assert(
+  sizeof(SBOVector<int, SBO_SIZE, MmapIntAllocator>) == sizeof(SBOVector<int, SBO_SIZE>)
+);
+
+TEST(MmapAllocator, MustMapAboveThreshold) {
+  MmapIntAllocator alloc;
+  EXPECT_FALSE(alloc.is_mapped(MMAP_THRESHOLD / sizeof(int) - 1));
+  EXPECT_TRUE(alloc.is_mapped(MMAP_THRESHOLD / sizeof(int)));
+  auto p = alloc.allocate(LARGE_SIZE * 100);
+  ASSERT_NE(p, nullptr);
+  // mappings are page aligned
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(p) % details_::MmapPageSize(), 0);
+  std::fill_n(p, LARGE_SIZE * 100, 7);
+  alloc.deallocate(p, LARGE_SIZE * 100);
+}
+
+TEST(MmapAllocator, MustReallocateKeepingContents) {
+  MmapIntAllocator alloc;
+  const size_t sizes[] = {SMALL_SIZE, LARGE_SIZE, LARGE_SIZE * 100, LARGE_SIZE * 10000};
+  size_t old_size = SMALL_SIZE;
+  auto p = alloc.allocate(old_size);
+  std::iota(p, p + old_size, 0);
+  for (auto new_size : sizes) {
+    if (new_size <= old_size) {
+      continue;
+    }
+    p = alloc.reallocate(p, old_size, new_size);
+    ASSERT_NE(p, nullptr);
+    for (size_t i = 0; i < old_size; ++i) {
+      ASSERT_EQ(p[i], static_cast<int>(i));
+    }
+    std::iota(p, p + new_size, 0);
+    old_size = new_size;
+  }
+  alloc.deallocate(p, old_size);
+}
+
+TEST(ValueVerifiedSBOVector, MustGrowThroughReallocate) {
+  auto vec = make_vector_sequence<LARGE_SIZE>();
+  SBOVector<int, SBO_SIZE, MmapIntAllocator> sbo;
+  std::vector<int> expected;
+  for (auto i = 0; i < 50; ++i) {
+    sbo.insert(sbo.begin() + static_cast<ptrdiff_t>(sbo.size() / 2), vec.begin(), vec.end());
+    expected.insert(expected.begin() + static_cast<ptrdiff_t>(expected.size() / 2), vec.begin(), vec.end());
+    sbo.push_back(i);
+    expected.push_back(i);
+  }
+  EXPECT_RANGE_EQ(sbo, expected);
+  sbo.reserve_if_external(sbo.size() * 4);
+  EXPECT_GE(sbo.capacity(), expected.size() * 4);
+  EXPECT_RANGE_EQ(sbo, expected);
+  sbo.shrink_to_fit_if_external();
+  EXPECT_RANGE_EQ(sbo, expected);
+  sbo.erase(sbo.begin() + SMALL_SIZE, sbo.end());
+  expected.erase(expected.begin() + SMALL_SIZE, expected.end());
+  EXPECT_RANGE_EQ(sbo, expected);
+}
+
+TEST(ValueVerifiedSBOVector, MustGrowThroughReallocateCompact) {
+  auto vec = make_vector_sequence<LARGE_SIZE>();
+  CompactSBOVector<int, SBO_SIZE, MmapAllocator<int, MMAP_THRESHOLD, kMmapPopulate>> sbo;
+  std::vector<int> expected;
+  for (auto i = 0; i < 50; ++i) {
+    sbo.insert(sbo.begin(), vec.begin(), vec.end());
+    expected.insert(expected.begin(), vec.begin(), vec.end());
+  }
+  EXPECT_RANGE_EQ(sbo, expected);
+}
+
+TEST(ValueVerifiedSBOVector, MustGrowHugePagePopulated) {
+  auto vec = make_vector_sequence<LARGE_SIZE>();
+  SBOVector<int, SBO_SIZE, MmapAllocator<int, MMAP_THRESHOLD, kMmapHugePages | kMmapPopulate>> sbo;
+  std::vector<int> expected;
+  for (auto i = 0; i < 50; ++i) {
+    sbo.insert(sbo.end(), vec.begin(), vec.end());
+    expected.insert(expected.end(), vec.begin(), vec.end());
+  }
+  EXPECT_RANGE_EQ(sbo, expected);
+}
+
+#endif  // defined(__linux__)
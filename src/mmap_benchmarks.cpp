@@ -0,0 +1,58 @@
+#include "benchmark_common.hpp"
+
+#include "sbovector.hpp"
+
+#if defined(__linux__)
+
+#include "mmap_allocator.hpp"
+
+#include <vector>
+
+// Growth of huge spilled vectors: std::allocator copies on every doubling and keeps
+// both buffers resident while doing so, MmapAllocator grows in place via mremap.
+// Compare time and peak_rss_MB between the variants.
+// 100M floats per variant: only registered with SBOVECTOR_BENCHMARK_LARGE=1
+
+template <typename ContainerType>
+void BM_PushBackHuge(benchmark::State& state) {
+  const auto count = static_cast<size_t>(state.range(0));
+  ScopedRSSCounters rss_counters;
+  for (auto _ : state) {
+    ContainerType c;
+    for (auto i = 0u; i < count; ++i) {
+      c.push_back(static_cast<float>(i));
+    }
+    benchmark::DoNotOptimize(c.data());
+  }
+  rss_counters.Report(state);
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+typedef SBOVector<float, 64> SBOVectorFloat64;
+typedef SBOVector<float, 64, MmapAllocator<float>> MmapSBOVectorFloat64;
+typedef SBOVector<float, 64, MmapAllocator<float, (size_t{1} << 20), kMmapHugePages>>
+    HugePageMmapSBOVectorFloat64;
+typedef SBOVector<float, 64, MmapAllocator<float, (size_t{1} << 20), kMmapPopulate>>
+    PopulateMmapSBOVectorFloat64;
+
+typedef SBOVector<float, 64,
+                  MmapAllocator<float, (size_t{1} << 20), kMmapHugePages | kMmapPopulate>>
+    HugePagePopulateMmapSBOVectorFloat64;
+
+#define HUGE_PUSH_BACK_BENCHMARK(TYPE)                                           \
+  benchmark::RegisterBenchmark("BM_PushBackHuge<" #TYPE ">", BM_PushBackHuge<TYPE>) \
+      ->Arg(100'000'000)                                                         \
+      ->Unit(benchmark::kMillisecond)                                            \
+      ->Iterations(1)
+
+static const bool kHugePushBackRegistered = LargeBenchmarksEnabled() && []() {
+  HUGE_PUSH_BACK_BENCHMARK(std::vector<float>);
+  HUGE_PUSH_BACK_BENCHMARK(SBOVectorFloat64);
+  HUGE_PUSH_BACK_BENCHMARK(MmapSBOVectorFloat64);
+  HUGE_PUSH_BACK_BENCHMARK(HugePageMmapSBOVectorFloat64);
+  HUGE_PUSH_BACK_BENCHMARK(PopulateMmapSBOVectorFloat64);
+  HUGE_PUSH_BACK_BENCHMARK(HugePagePopulateMmapSBOVectorFloat64);
+  return true;
+}();
+
+#endif  // defined(__linux__)
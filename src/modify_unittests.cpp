@@ -642,4 +642,26 @@ TEST_F(DataTypeOperationTrackingSBOVector, MustClear) {
   EXPECT_TRUE(empty.empty());
   EXPECT_TRUE(small.empty());
   EXPECT_TRUE(large.empty());
-}
\ No newline at end of file
+}
+
+TEST(ValueVerifiedSBOVector, MustAppendUninitialized) {
+  SBOVector<int, SBO_SIZE> sbo(SMALL_SIZE, 1);
+  const auto written = sbo.append_uninitialized(LARGE_SIZE, [](int* tail, size_t max_count) {
+    EXPECT_EQ(max_count, LARGE_SIZE);
+    std::fill_n(tail, 3, 2);
+    return size_t{3};
+  });
+  EXPECT_EQ(written, 3);
+  // grown past BufferSize for the fill, but internalized again once truncated
+  EXPECT_EQ(sbo.capacity(), SBO_SIZE);
+  std::vector<int> expected(SMALL_SIZE, 1);
+  expected.insert(expected.end(), 3, 2);
+  EXPECT_RANGE_EQ(sbo, expected);
+
+  sbo.append_uninitialized(LARGE_SIZE, [](int* tail, size_t max_count) {
+    std::fill_n(tail, max_count, 3);
+    return max_count;
+  });
+  expected.insert(expected.end(), LARGE_SIZE, 3);
+  EXPECT_RANGE_EQ(sbo, expected);
+}
@@ -0,0 +1,219 @@
+#include "benchmark_common.hpp"
+
+#include "sbovector.hpp"
+#include "sbovector_parallel.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <thread>
+#include <vector>
+
+// sbo::parallel algorithms over spilled SBOVector<int32_t, 64>
+// range(0): elements (1M, 10M, 100M), range(1): threads (pool workers + the caller)
+// threads:1 runs on a pool without workers, i.e. the chunked code on the calling thread
+
+namespace {
+
+using Elements = SBOVector<int32_t, 64>;
+
+void ElementsAndThreads(benchmark::internal::Benchmark* benchmark) {
+  const auto max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  for (auto elements : {1 << 20, 10 << 20, 100 << 20}) {
+    // powers of two then every hardware thread
+    for (auto threads = 1; threads < max_threads; threads *= 2) {
+      benchmark->Args({elements, threads});
+    }
+    benchmark->Args({elements, max_threads});
+  }
+}
+
+Elements MakeShuffled(size_t count) {
+  Elements out(count);
+  std::iota(out.begin(), out.end(), 0);
+  std::shuffle(out.begin(), out.end(), std::mt19937(42));
+  return out;
+}
+
+template <typename Fn>
+void RunParallel(benchmark::State& state, Fn&& fn) {
+  const auto count = static_cast<size_t>(state.range(0));
+  sbo::parallel::ThreadPool pool(static_cast<size_t>(state.range(1)) - 1);
+  auto elements = MakeShuffled(count);
+  for (auto _ : state) {
+    fn(state, pool, elements);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+}  // namespace
+
+static void BM_ParallelSort(benchmark::State& state) {
+  const auto shuffled = MakeShuffled(static_cast<size_t>(state.range(0)));
+  RunParallel(state, [&](benchmark::State& s, sbo::parallel::ThreadPool& pool, Elements& elements) {
+    s.PauseTiming();
+    std::copy(shuffled.begin(), shuffled.end(), elements.begin());
+    s.ResumeTiming();
+    sbo::parallel::sort(pool, elements);
+  });
+}
+
+static void BM_ParallelTransform(benchmark::State& state) {
+  RunParallel(state, [](benchmark::State&, sbo::parallel::ThreadPool& pool, Elements& elements) {
+    sbo::parallel::transform(pool, elements, elements, [](int32_t v) { return v * 3 + 1; });
+  });
+}
+
+static void BM_ParallelReduce(benchmark::State& state) {
+  RunParallel(state, [](benchmark::State&, sbo::parallel::ThreadPool& pool, Elements& elements) {
+    benchmark::DoNotOptimize(sbo::parallel::reduce(pool, elements, int64_t{0}));
+  });
+}
+
+static void BM_ParallelFill(benchmark::State& state) {
+  RunParallel(state, [](benchmark::State&, sbo::parallel::ThreadPool& pool, Elements& elements) {
+    sbo::parallel::fill(pool, elements, int32_t{7});
+    benchmark::ClobberMemory();
+  });
+}
+
+BENCHMARK(BM_ParallelSort)->Apply(ElementsAndThreads)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_ParallelTransform)->Apply(ElementsAndThreads)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_ParallelReduce)->Apply(ElementsAndThreads)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_ParallelFill)->Apply(ElementsAndThreads)->Unit(benchmark::kMillisecond)->UseRealTime();
+
+// Adjacency lists of a synthetic power law graph: mostly inline, a few 100K edge hubs
+// ByVertex: sbo::parallel::for_each over the vertices (even split by index)
+// ByEdge: sbo::parallel::for_each_element (split by cumulative edge count)
+// range(0): threads
+
+namespace {
+
+struct Edge {
+  uint32_t to_;
+  float weight_;
+};
+
+using Graph = std::vector<SBOVector<Edge, 8>>;
+
+const Graph& PowerLawGraph() {
+  static const Graph graph = []() {
+    constexpr uint32_t kVertices = 1 << 20;
+    constexpr double kAlpha = 1.1;
+    constexpr size_t kMaxDegree = 100000;
+    std::mt19937 random(42);
+    std::uniform_real_distribution<double> uniform(1e-9, 1.0);
+    Graph out(kVertices);
+    for (auto& edges : out) {
+      // pareto distributed degree
+      const auto degree = std::min(kMaxDegree, static_cast<size_t>(std::pow(uniform(random), -1.0 / kAlpha)));
+      for (size_t i = 0; i < degree; ++i) {
+        edges.push_back({static_cast<uint32_t>(random() % kVertices), 1.0f});
+      }
+    }
+    return out;
+  }();
+  return graph;
+}
+
+// a little work per edge
+inline float Relax(const Edge& edge) {
+  auto value = static_cast<float>(edge.to_) * edge.weight_;
+  for (auto i = 0; i < 8; ++i) {
+    value = value * 0.5f + 1.0f;
+  }
+  return value;
+}
+
+// One accumulator per thread, a cache line each, combined once at the end: a shared sum
+// would measure cache line ping-pong rather than the load balancing
+class PerThreadSums {
+  struct alignas(64) Slot {
+    float value_{0.0f};
+  };
+
+  std::vector<Slot> slots_;
+  std::atomic<size_t> claimed_{0};
+  size_t generation_;
+
+  static std::atomic<size_t>& generations() {
+    static std::atomic<size_t> counter{0};
+    return counter;
+  }
+
+ public:
+  // threads: every thread that may call local()
+  explicit PerThreadSums(size_t threads) : slots_(threads), generation_(++generations()) {}
+
+  // the calling thread's slot (claimed on first use)
+  float& local() {
+    static thread_local size_t generation = 0;
+    static thread_local float* slot = nullptr;
+    if (generation != generation_) {
+      generation = generation_;
+      slot = &slots_[claimed_.fetch_add(1, std::memory_order_relaxed)].value_;
+    }
+    return *slot;
+  }
+
+  // after the parallel section
+  float total() const {
+    float out = 0.0f;
+    for (const auto& slot : slots_) {
+      out += slot.value_;
+    }
+    return out;
+  }
+};
+
+void Threads(benchmark::internal::Benchmark* benchmark) {
+  const auto max_threads = static_cast<int>(std::max(1u, std::thread::hardware_concurrency()));
+  for (auto threads = 1; threads < max_threads; threads *= 2) {
+    benchmark->Arg(threads);
+  }
+  benchmark->Arg(max_threads);
+}
+
+template <typename Fn>
+void RunGraph(benchmark::State& state, Fn&& fn) {
+  const auto& graph = PowerLawGraph();
+  sbo::parallel::ThreadPool pool(static_cast<size_t>(state.range(0)) - 1);
+  size_t edges = 0;
+  for (const auto& vertex : graph) {
+    edges += vertex.size();
+  }
+  for (auto _ : state) {
+    PerThreadSums sums(pool.concurrency());
+    fn(pool, graph, sums);
+    benchmark::DoNotOptimize(sums.total());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(edges));
+}
+
+}  // namespace
+
+static void BM_GraphByVertex(benchmark::State& state) {
+  RunGraph(state, [](sbo::parallel::ThreadPool& pool, const Graph& graph, PerThreadSums& sums) {
+    sbo::parallel::for_each(pool, graph, [&sums](const SBOVector<Edge, 8>& edges) {
+      float local = 0.0f;
+      for (const auto& edge : edges) {
+        local += Relax(edge);
+      }
+      sums.local() += local;
+    });
+  });
+}
+
+static void BM_GraphByEdge(benchmark::State& state) {
+  RunGraph(state, [](sbo::parallel::ThreadPool& pool, const Graph& graph, PerThreadSums& sums) {
+    sbo::parallel::for_each_element(pool, graph, [&sums](const Edge& edge) {
+      sums.local() += Relax(edge);
+    });
+  });
+}
+
+BENCHMARK(BM_GraphByVertex)->Apply(Threads)->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_GraphByEdge)->Apply(Threads)->Unit(benchmark::kMillisecond)->UseRealTime();
@@ -0,0 +1,157 @@
+#include "unittest_common.hpp"
+
+#include "sbovector_parallel.hpp"
+
+#include <random>
+
+// Unittests for the sbo::parallel algorithms
+
+namespace {
+
+// above sbo::parallel::kSequentialCutoff so the parallel paths run
+constexpr size_t PARALLEL_SIZE = sbo::parallel::kSequentialCutoff * 8 + 3;
+
+template <size_t Size>
+SBOVector<int64_t, SBO_SIZE> MakeShuffled() {
+  SBOVector<int64_t, SBO_SIZE> out(Size);
+  std::iota(out.begin(), out.end(), 0);
+  std::shuffle(out.begin(), out.end(), std::mt19937(42));
+  return out;
+}
+
+}  // namespace
+
+template <typename T>
+struct ParallelSBOVector_ : public ::testing::Test {};
+
+// worker counts: sequential pool, injected pool, default pool
+using PoolWorkers = ::testing::Types<
+  std::integral_constant<size_t, 0>,
+  std::integral_constant<size_t, 3>,
+  std::integral_constant<size_t, SIZE_MAX>
+>;
+TYPED_TEST_SUITE(ParallelSBOVector_, PoolWorkers);
+
+namespace {
+
+template <typename Workers, typename Fn>
+void WithPool(Fn&& fn) {
+  if constexpr (Workers::value == SIZE_MAX) {
+    fn(sbo::parallel::default_pool());
+  } else {
+    sbo::parallel::ThreadPool pool(Workers::value);
+    fn(pool);
+  }
+}
+
+}  // namespace
+
+TYPED_TEST(ParallelSBOVector_, MustSort) {
+  WithPool<TypeParam>([](sbo::parallel::ThreadPool& pool) {
+    for (auto sbo : {MakeShuffled<SMALL_SIZE>(), MakeShuffled<LARGE_SIZE>(),
+                     MakeShuffled<PARALLEL_SIZE>()}) {
+      auto expected = sbo;
+      std::sort(expected.begin(), expected.end(), std::greater<>());
+      sbo::parallel::sort(pool, sbo, std::greater<>());
+      EXPECT_RANGE_EQ(sbo, expected);
+    }
+  });
+}
+
+TYPED_TEST(ParallelSBOVector_, MustTransformAndCopy) {
+  WithPool<TypeParam>([](sbo::parallel::ThreadPool& pool) {
+    const auto input = MakeShuffled<PARALLEL_SIZE>();
+    SBOVector<int64_t, SBO_SIZE> output(PARALLEL_SIZE);
+    sbo::parallel::transform(pool, input, output, [](int64_t v) { return v * 3; });
+    for (auto i = 0u; i < PARALLEL_SIZE; ++i) {
+      ASSERT_EQ(output[i], input[i] * 3);
+    }
+    sbo::parallel::copy(pool, input, output);
+    EXPECT_RANGE_EQ(output, input);
+  });
+}
+
+TYPED_TEST(ParallelSBOVector_, MustReduce) {
+  WithPool<TypeParam>([](sbo::parallel::ThreadPool& pool) {
+    const auto input = MakeShuffled<PARALLEL_SIZE>();
+    const auto expected = static_cast<int64_t>(PARALLEL_SIZE * (PARALLEL_SIZE - 1) / 2);
+    EXPECT_EQ(sbo::parallel::reduce(pool, input, int64_t{7}), expected + 7);
+    EXPECT_EQ(sbo::parallel::reduce(pool, MakeShuffled<SMALL_SIZE>(), int64_t{0}),
+              static_cast<int64_t>(SMALL_SIZE * (SMALL_SIZE - 1) / 2));
+    EXPECT_EQ(sbo::parallel::reduce(pool, input, int64_t{0},
+                                    [](int64_t a, int64_t b) { return std::max(a, b); }),
+              static_cast<int64_t>(PARALLEL_SIZE - 1));
+  });
+}
+
+TYPED_TEST(ParallelSBOVector_, MustFillAndForEach) {
+  WithPool<TypeParam>([](sbo::parallel::ThreadPool& pool) {
+    SBOVector<int64_t, SBO_SIZE> sbo(PARALLEL_SIZE);
+    sbo::parallel::fill(pool, sbo, int64_t{5});
+    sbo::parallel::for_each(pool, sbo, [](int64_t& v) { ++v; });
+    EXPECT_EQ(std::count(sbo.begin(), sbo.end(), 6), static_cast<ptrdiff_t>(PARALLEL_SIZE));
+  });
+}
+
+TEST(ValueVerifiedParallelSBOVector, MustRunNestedTasks) {
+  // tasks waiting on nested groups run other tasks instead of blocking the workers
+  sbo::parallel::ThreadPool pool(2);
+  std::atomic<int> leaves{0};
+  sbo::parallel::TaskGroup outer(pool);
+  for (auto i = 0; i < 8; ++i) {
+    outer.run([&]() {
+      sbo::parallel::TaskGroup inner(pool);
+      for (auto j = 0; j < 8; ++j) {
+        inner.run([&]() { ++leaves; });
+      }
+      inner.wait();
+    });
+  }
+  outer.wait();
+  EXPECT_EQ(leaves.load(), 64);
+}
+
+TEST(ValueVerifiedParallelSBOVector, MustUseDefaultPool) {
+  auto sbo = MakeShuffled<PARALLEL_SIZE>();
+  sbo::parallel::sort(sbo);
+  EXPECT_TRUE(std::is_sorted(sbo.begin(), sbo.end()));
+  EXPECT_EQ(sbo::parallel::reduce(sbo, int64_t{0}),
+            static_cast<int64_t>(PARALLEL_SIZE * (PARALLEL_SIZE - 1) / 2));
+}
+
+TYPED_TEST(ParallelSBOVector_, MustVisitEveryElementOfSkewedCollections) {
+  WithPool<TypeParam>([](sbo::parallel::ThreadPool& pool) {
+    // mostly inline (and empty) inner vectors, a few hubs far above the cutoff
+    std::vector<SBOVector<int, SMALL_SIZE>> collection;
+    for (auto i = 0u; i < LARGE_SIZE * 100; ++i) {
+      collection.emplace_back(i % 10 == 0 ? 0 : i % SMALL_SIZE, 0);
+      if (i % (LARGE_SIZE * 30) == 1) {
+        collection.emplace_back(PARALLEL_SIZE, 0);
+      }
+    }
+    collection.emplace_back();
+
+    sbo::parallel::for_each_element(pool, collection, [](int& v) { ++v; });
+    for (const auto& inner : collection) {
+      ASSERT_EQ(std::count(inner.begin(), inner.end(), 1), static_cast<ptrdiff_t>(inner.size()));
+    }
+    sbo::parallel::for_each_element(pool, collection, [](size_t outer, int& v) {
+      v = static_cast<int>(outer);
+    });
+    for (auto i = 0u; i < collection.size(); ++i) {
+      ASSERT_EQ(std::count(collection[i].begin(), collection[i].end(), static_cast<int>(i)),
+                static_cast<ptrdiff_t>(collection[i].size()));
+    }
+  });
+}
+
+TEST(ValueVerifiedParallelSBOVector, MustVisitSmallCollections) {
+  std::vector<SBOVector<int, SMALL_SIZE>> collection(SMALL_SIZE, SBOVector<int, SMALL_SIZE>(SMALL_SIZE, 1));
+  int sum = 0;
+  // below the cutoff: sequential on the calling thread
+  sbo::parallel::for_each_element(collection, [&sum](const int& v) { sum += v; });
+  EXPECT_EQ(sum, static_cast<int>(SMALL_SIZE * SMALL_SIZE));
+  std::vector<SBOVector<int, SMALL_SIZE>> empty;
+  sbo::parallel::for_each_element(empty, [&sum](int&) { ++sum; });
+  EXPECT_EQ(sum, static_cast<int>(SMALL_SIZE * SMALL_SIZE));
+}
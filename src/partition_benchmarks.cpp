@@ -0,0 +1,65 @@
+#include "benchmark_common.hpp"
+
+#include "sbovector.hpp"
+#include "sbovector_partition.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// Partitioning 1M uint32_t keys into K fresh SBOVector<uint32_t, 16> buckets by a hash
+// PushBack: one push_back per key
+// PartitionInto: histogram, one growth per bucket, write combined scatter
+// range(0): K
+
+namespace {
+
+constexpr size_t kKeys = 1 << 20;
+using Bucket = SBOVector<uint32_t, 16>;
+
+const std::vector<uint32_t>& Keys() {
+  static const std::vector<uint32_t> keys = []() {
+    std::mt19937 random(42);
+    std::vector<uint32_t> out(kKeys);
+    for (auto& key : out) {
+      key = static_cast<uint32_t>(random());
+    }
+    return out;
+  }();
+  return keys;
+}
+
+template <typename Partition>
+void RunPartition(benchmark::State& state, Partition&& partition) {
+  const auto& keys = Keys();
+  const auto bucket_count = static_cast<uint32_t>(state.range(0));
+  // multiplicative hash, top bits select the bucket (K is a power of two)
+  const auto key_fn = [bucket_count](uint32_t key) -> size_t {
+    return (uint64_t{key * 2654435761u} * bucket_count) >> 32;
+  };
+  for (auto _ : state) {
+    std::vector<Bucket> buckets(bucket_count);
+    partition(buckets, keys, key_fn);
+    benchmark::DoNotOptimize(buckets.data());
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kKeys));
+}
+
+}  // namespace
+
+static void BM_PartitionPushBack(benchmark::State& state) {
+  RunPartition(state, [](std::vector<Bucket>& buckets, const std::vector<uint32_t>& keys, auto key_fn) {
+    for (auto key : keys) {
+      buckets[key_fn(key)].push_back(key);
+    }
+  });
+}
+
+static void BM_PartitionInto(benchmark::State& state) {
+  RunPartition(state, [](std::vector<Bucket>& buckets, const std::vector<uint32_t>& keys, auto key_fn) {
+    partition_into(buckets, keys.begin(), keys.end(), key_fn);
+  });
+}
+
+BENCHMARK(BM_PartitionPushBack)->Arg(16)->Arg(256)->Arg(4096)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_PartitionInto)->Arg(16)->Arg(256)->Arg(4096)->Unit(benchmark::kMillisecond);
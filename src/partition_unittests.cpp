@@ -0,0 +1,69 @@
+#include "unittest_common.hpp"
+
+#include "sbovector_partition.hpp"
+
+#include <random>
+
+// Unittests for partition_into
+
+namespace {
+
+template <typename Buckets, typename Container, typename KeyFn>
+Buckets NaivePartition(Buckets buckets, const Container& input, KeyFn key_fn) {
+  for (const auto& value : input) {
+    buckets[key_fn(value)].push_back(value);
+  }
+  return buckets;
+}
+
+// not trivial (default member initializer): takes the push_back path
+struct Tagged {
+  int value_ = -1;
+  bool operator==(const Tagged& other) const { return value_ == other.value_; }
+};
+
+}  // namespace
+
+TEST(ValueVerifiedSBOVector, MustPartitionInto) {
+  std::mt19937 random(42);
+  std::vector<uint32_t> input(LARGE_SIZE * 100);
+  for (auto& value : input) {
+    value = static_cast<uint32_t>(random());
+  }
+  for (size_t bucket_count : {size_t{1}, SMALL_SIZE, SBO_SIZE, LARGE_SIZE * 10}) {
+    const auto key_fn = [bucket_count](uint32_t value) { return value % bucket_count; };
+    std::vector<SBOVector<uint32_t, SBO_SIZE>> buckets(bucket_count);
+    // existing contents are kept, new elements are appended in input order
+    buckets.at(0).assign(SMALL_SIZE, 7u);
+    const auto expected = NaivePartition(buckets, input, key_fn);
+    partition_into(buckets, input.begin(), input.end(), key_fn);
+    ASSERT_EQ(buckets.size(), expected.size());
+    for (auto i = 0u; i < bucket_count; ++i) {
+      EXPECT_RANGE_EQ(buckets[i], expected[i]);
+    }
+  }
+}
+
+TEST(ValueVerifiedSBOVector, MustPartitionIntoEmpty) {
+  std::vector<int> input;
+  std::vector<SBOVector<int, SBO_SIZE>> buckets(SMALL_SIZE);
+  partition_into(buckets, input.begin(), input.end(), [](int) { return 0; });
+  for (const auto& bucket : buckets) {
+    EXPECT_TRUE(bucket.empty());
+  }
+}
+
+TEST(ValueVerifiedSBOVector, MustPartitionIntoNonTrivial) {
+  std::vector<Tagged> input;
+  for (auto i = 0; i < static_cast<int>(LARGE_SIZE); ++i) {
+    input.push_back({i});
+  }
+  const auto key_fn = [](const Tagged& tagged) { return static_cast<size_t>(tagged.value_ % 3); };
+  std::array<SBOVector<Tagged, SMALL_SIZE>, 3> buckets;
+  buckets[1].assign(LARGE_SIZE, Tagged{});
+  const auto expected = NaivePartition(buckets, input, key_fn);
+  partition_into(buckets, input.begin(), input.end(), key_fn);
+  for (auto i = 0u; i < buckets.size(); ++i) {
+    EXPECT_RANGE_EQ(buckets[i], expected[i]);
+  }
+}
@@ -0,0 +1,151 @@
+// Routes the SBOVector tracepoints to a local tracer (must precede every include of sbovector.hpp)
+// Built as its own probe_unittest executable: every translation unit of a program must agree
+// on SBOVECTOR_PROBE
+#include <cstddef>
+#include <string>
+#include <vector>
+
+struct ProbeEvent {
+  std::string name_;
+  size_t element_size_;
+  size_t old_count_;
+  size_t new_count_;
+  size_t old_capacity_;
+  size_t new_capacity_;
+  size_t buffer_size_;
+  size_t moved_;
+};
+
+std::vector<ProbeEvent>& ProbeEvents() {
+  static std::vector<ProbeEvent> events;
+  return events;
+}
+
+#define SBOVECTOR_PROBE(name, ...) ProbeEvents().push_back({#name, __VA_ARGS__})
+
+#include "unittest_common.hpp"
+
+#if defined(__linux__)
+#include "mmap_allocator.hpp"
+#endif
+
+// Unittests for the SBOVECTOR_PROBE tracepoints
+// (only ProbedElement vectors are instantiated in this file: their probes are not compiled out)
+
+namespace {
+
+struct ProbedElement {
+  int value_;
+};
+
+using ProbedVector = SBOVector<ProbedElement, SMALL_SIZE>;
+
+ProbedVector MakeProbed(size_t count) {
+  ProbedVector out;
+  for (auto i = 0u; i < count; ++i) {
+    out.push_back({static_cast<int>(i)});
+  }
+  return out;
+}
+
+}  // namespace
+
+TEST(ValueVerifiedProbes, MustFireOnGrowthAndInternalize) {
+  ProbeEvents().clear();
+  auto sbo = MakeProbed(SMALL_SIZE + 1);
+  sbo.insert(sbo.end(), SBO_SIZE, ProbedElement{0});
+  sbo.erase(sbo.begin() + 1, sbo.end());
+
+  ASSERT_EQ(ProbeEvents().size(), 3u);
+  // push_back: spill from inline
+  const auto& spill = ProbeEvents()[0];
+  EXPECT_EQ(spill.name_, "reserve");
+  EXPECT_EQ(spill.element_size_, sizeof(ProbedElement));
+  EXPECT_EQ(spill.old_count_, SMALL_SIZE);
+  EXPECT_EQ(spill.new_count_, SMALL_SIZE + 1);
+  EXPECT_EQ(spill.old_capacity_, SMALL_SIZE);
+  EXPECT_EQ(spill.new_capacity_, 2 * SMALL_SIZE);
+  EXPECT_EQ(spill.buffer_size_, SMALL_SIZE);
+  EXPECT_EQ(spill.moved_, SMALL_SIZE);
+
+  const auto& grow = ProbeEvents()[1];
+  EXPECT_EQ(grow.name_, "grow");
+  EXPECT_EQ(grow.old_count_, SMALL_SIZE + 1);
+  EXPECT_EQ(grow.new_count_, SMALL_SIZE + 1 + SBO_SIZE);
+  EXPECT_EQ(grow.old_capacity_, 2 * SMALL_SIZE);
+  EXPECT_EQ(grow.new_capacity_, SMALL_SIZE + 1 + SBO_SIZE);
+  EXPECT_EQ(grow.moved_, SMALL_SIZE + 1);
+
+  const auto& internalize = ProbeEvents()[2];
+  EXPECT_EQ(internalize.name_, "internalize");
+  EXPECT_EQ(internalize.old_count_, 1u);
+  EXPECT_EQ(internalize.old_capacity_, SMALL_SIZE + 1 + SBO_SIZE);
+  EXPECT_EQ(internalize.new_capacity_, SMALL_SIZE);
+  EXPECT_EQ(internalize.moved_, 1u);
+}
+
+TEST(ValueVerifiedProbes, MustFireOnShrinkToFit) {
+  auto sbo = MakeProbed(LARGE_SIZE + 1);
+  ProbeEvents().clear();
+  sbo.shrink_to_fit_if_external();
+  ASSERT_EQ(ProbeEvents().size(), 1u);
+  EXPECT_EQ(ProbeEvents()[0].name_, "shrink_to_fit");
+  EXPECT_EQ(ProbeEvents()[0].new_capacity_, LARGE_SIZE + 1);
+}
+
+TEST(ValueVerifiedProbes, MustFireOnAllocatingSwap) {
+  // different BufferSizes: swap_cross moves the elements
+  SBOVector<ProbedElement, SBO_SIZE> large(SBO_SIZE, ProbedElement{0});
+  auto small = MakeProbed(SMALL_SIZE);
+  ProbeEvents().clear();
+  small.swap(large);
+  ASSERT_EQ(ProbeEvents().size(), 1u);
+  EXPECT_EQ(ProbeEvents()[0].name_, "one_alloc_swap");
+  EXPECT_EQ(ProbeEvents()[0].new_count_, SBO_SIZE);
+  EXPECT_EQ(ProbeEvents()[0].buffer_size_, SMALL_SIZE);
+  EXPECT_EQ(ProbeEvents()[0].moved_, SBO_SIZE);
+
+  // (two_alloc_swap is not reachable: one side's capacity always fits the other's count)
+}
+
+TEST(ValueVerifiedProbes, MustFireOnHandOverSwap) {
+  auto inlined = MakeProbed(SMALL_SIZE - 1);
+  auto external = MakeProbed(LARGE_SIZE);
+  const auto external_capacity = external.capacity();
+  ProbeEvents().clear();
+  inlined.swap(external);
+  ASSERT_EQ(ProbeEvents().size(), 2u);
+  // the spilled side going inline, then the inline side taking its buffer
+  const auto& internalized = ProbeEvents()[0];
+  EXPECT_EQ(internalized.name_, "hand_over_swap");
+  EXPECT_EQ(internalized.old_count_, LARGE_SIZE);
+  EXPECT_EQ(internalized.new_count_, SMALL_SIZE - 1);
+  EXPECT_EQ(internalized.old_capacity_, external_capacity);
+  EXPECT_EQ(internalized.new_capacity_, SMALL_SIZE);
+  EXPECT_EQ(internalized.moved_, SMALL_SIZE - 1);
+  const auto& spilled = ProbeEvents()[1];
+  EXPECT_EQ(spilled.name_, "hand_over_swap");
+  EXPECT_EQ(spilled.old_count_, SMALL_SIZE - 1);
+  EXPECT_EQ(spilled.new_count_, LARGE_SIZE);
+  EXPECT_EQ(spilled.old_capacity_, SMALL_SIZE);
+  EXPECT_EQ(spilled.new_capacity_, external_capacity);
+  EXPECT_EQ(spilled.moved_, 0u);
+}
+
+#if defined(__linux__)
+
+TEST(ValueVerifiedProbes, MustNotCountMovedOnReallocate) {
+  // every buffer mapped: growth of a spilled vector is relocated by mremap
+  SBOVector<ProbedElement, SMALL_SIZE, MmapAllocator<ProbedElement, 0>> sbo;
+  for (auto i = 0u; i <= SMALL_SIZE; ++i) {
+    sbo.push_back({static_cast<int>(i)});
+  }
+  ProbeEvents().clear();
+  sbo.insert(sbo.end(), LARGE_SIZE, ProbedElement{0});
+  ASSERT_EQ(ProbeEvents().size(), 1u);
+  EXPECT_EQ(ProbeEvents()[0].name_, "grow");
+  EXPECT_EQ(ProbeEvents()[0].old_count_, SMALL_SIZE + 1);
+  EXPECT_EQ(ProbeEvents()[0].moved_, 0u);
+}
+
+#endif  // defined(__linux__)
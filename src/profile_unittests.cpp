@@ -0,0 +1,112 @@
+#include "unittest_common.hpp"
+
+#include "sbovector_profile.hpp"
+
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+
+// Unittests for the SBOVectorProfile policy and its BufferSize advice
+
+struct ProfiledElement {
+  int value_;
+};
+
+template <>
+struct sbovector_stats_policy<ProfiledElement, SMALL_SIZE, std::allocator<ProfiledElement>, false> {
+  using type = SBOVectorProfile<ProfiledElement, SMALL_SIZE, std::allocator<ProfiledElement>, false>;
+};
+
+namespace {
+
+using ProfiledVector = SBOVector<ProfiledElement, SMALL_SIZE>;
+
+// the exit report defaults to stderr: keep it out of the test output unless asked for
+const bool kQuietExitReport = []() {
+  if (!std::getenv("SBOVECTOR_PROFILE_OUT")) {
+    configure_sbovector_profile(
+        (std::filesystem::temp_directory_path() / "sbovector_profile_unittests.txt").string());
+  }
+  return true;
+}();
+
+void BuildProfiled(size_t peak, size_t final_size) {
+  ProfiledVector sbo;
+  for (auto i = 0u; i < peak; ++i) {
+    sbo.push_back({static_cast<int>(i)});
+  }
+  sbo.erase(sbo.begin() + static_cast<std::ptrdiff_t>(final_size), sbo.end());
+}
+
+std::string SiteReport(const char* tag, double percentile) {
+  std::ostringstream out;
+  write_sbovector_profile(out, percentile);
+  const auto report = out.str();
+  const auto begin = report.find(tag);
+  return begin == std::string::npos ? std::string{} : report.substr(begin, report.find("\n<", begin) - begin);
+}
+
+}  // namespace
+
+static_assert(sizeof(ProfiledVector) == sizeof(SBOVector<int, SMALL_SIZE>) + 2 * sizeof(size_t));
+
+TEST(ValueVerifiedProfile, MustRecordFinalAndPeakSizesPerTag) {
+  {
+    SBOVectorProfileTag tag("<profile.sizes>");
+    for (auto i = 0u; i < 10; ++i) {
+      BuildProfiled(LARGE_SIZE, 1);
+    }
+  }
+  {
+    // other site, not counted above
+    SBOVectorProfileTag tag("<profile.other>");
+    BuildProfiled(SMALL_SIZE, SMALL_SIZE);
+  }
+  const auto report = SiteReport("<profile.sizes>", 0.99);
+  EXPECT_NE(report.find("ProfiledElement, 5> vectors: 10"), std::string::npos) << report;
+  EXPECT_NE(report.find("final size: p50: 1 p90: 1 p99: 1 max: 1"), std::string::npos) << report;
+  EXPECT_NE(report.find("peak size: p50: 100 p90: 100 p99: 100 max: 100"), std::string::npos)
+      << report;
+}
+
+TEST(ValueVerifiedProfile, MustRecommendTheCheapestBufferSize) {
+  {
+    // 90% at 3: spilling the 10% at 50 is cheaper than 50 inline elements everywhere
+    SBOVectorProfileTag tag("<profile.rare_spill>");
+    for (auto i = 0u; i < 90; ++i) {
+      BuildProfiled(3, 3);
+    }
+    for (auto i = 0u; i < 10; ++i) {
+      BuildProfiled(50, 50);
+    }
+  }
+  EXPECT_NE(SiteReport("<profile.rare_spill>", 0.99).find("recommended BufferSize: 3 "),
+            std::string::npos);
+  {
+    // 60% at 20: spilling them costs more than 20 inline elements
+    SBOVectorProfileTag tag("<profile.common_spill>");
+    for (auto i = 0u; i < 40; ++i) {
+      BuildProfiled(3, 3);
+    }
+    for (auto i = 0u; i < 60; ++i) {
+      BuildProfiled(20, 20);
+    }
+  }
+  EXPECT_NE(SiteReport("<profile.common_spill>", 0.99).find("recommended BufferSize: 20 "),
+            std::string::npos);
+  // the percentile bounds the recommendation
+  EXPECT_NE(SiteReport("<profile.common_spill>", 0.3).find("recommended BufferSize: 3 "),
+            std::string::npos);
+}
+
+TEST(ValueVerifiedProfile, MustTagWithFileAndLine) {
+  std::string expected;
+  {
+    SBOVECTOR_PROFILE_HERE;
+    expected = SBOVectorProfileTag::current();
+    BuildProfiled(SMALL_SIZE, SMALL_SIZE);
+  }
+  EXPECT_EQ(SBOVectorProfileTag::current(), nullptr);
+  EXPECT_NE(expected.find("profile_unittests.cpp:"), std::string::npos);
+  EXPECT_FALSE(SiteReport(expected.c_str(), 0.99).empty());
+}
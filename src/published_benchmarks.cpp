@@ -0,0 +1,116 @@
+#include "benchmark_common.hpp"
+
+#include "published_sbovector.hpp"
+#include "sbovector.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+// Readers summing a shared table on every "request" while one writer replaces it at 1 kHz
+// SharedMutex: SBOVector behind a std::shared_mutex (shared_lock per read)
+// Published: PublishedSBOVector snapshot per read
+// range(0): table size, inline (16) or spilled (256)
+
+namespace {
+
+constexpr size_t kTableSBOSize = 16;
+
+class SharedMutexTable {
+  mutable std::shared_mutex mutex_;
+  SBOVector<int, kTableSBOSize> values_;
+
+ public:
+  void publish(const std::vector<int>& values) {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    values_.assign(values.begin(), values.end());
+  }
+
+  int64_t sum() const {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    int64_t out = 0;
+    for (auto value : values_) {
+      out += value;
+    }
+    return out;
+  }
+};
+
+class PublishedTable {
+  PublishedSBOVector<int, kTableSBOSize> values_;
+
+ public:
+  void publish(const std::vector<int>& values) { values_.publish(values); }
+
+  int64_t sum() const {
+    const auto snapshot = values_.snapshot();
+    int64_t out = 0;
+    for (auto value : snapshot) {
+      out += value;
+    }
+    return out;
+  }
+};
+
+// one table and its 1 kHz writer, shared by the benchmark threads
+template <typename Table>
+class WrittenTable {
+  Table table_;
+  std::atomic<bool> stop_{false};
+  std::thread writer_;
+
+ public:
+  explicit WrittenTable(size_t size) {
+    std::vector<int> values(size, 1);
+    table_.publish(values);
+    writer_ = std::thread([this, values]() mutable {
+      while (!stop_.load()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ++values.front();
+        table_.publish(values);
+      }
+    });
+  }
+
+  ~WrittenTable() {
+    stop_ = true;
+    writer_.join();
+  }
+
+  const Table& table() const { return table_; }
+};
+
+template <typename Table>
+void RunReaders(benchmark::State& state) {
+  // the loop start/end are barriers between the benchmark threads
+  static std::unique_ptr<WrittenTable<Table>> shared;
+  if (ThreadIndex(state) == 0) {
+    shared = std::make_unique<WrittenTable<Table>>(static_cast<size_t>(state.range(0)));
+  }
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(shared->table().sum());
+  }
+  if (ThreadIndex(state) == 0) {
+    shared.reset();
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+static void BM_ReadSharedMutexSBOVector(benchmark::State& state) {
+  RunReaders<SharedMutexTable>(state);
+}
+
+static void BM_ReadPublishedSBOVector(benchmark::State& state) {
+  RunReaders<PublishedTable>(state);
+}
+
+BENCHMARK(BM_ReadSharedMutexSBOVector)->Arg(kTableSBOSize)->Arg(256)
+    ->ThreadRange(1, 32)->UseRealTime();
+BENCHMARK(BM_ReadPublishedSBOVector)->Arg(kTableSBOSize)->Arg(256)
+    ->ThreadRange(1, 32)->UseRealTime();
@@ -0,0 +1,224 @@
+#ifndef PUBLISHED_SBOVECTOR_HPP
+#define PUBLISHED_SBOVECTOR_HPP
+
+#include "sbovector.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+namespace details_ {
+
+constexpr size_t kPublishedCacheLineSize = 64;
+
+// Reader counts for one parity of the epoch, readers spread over stripes by thread
+struct alignas(kPublishedCacheLineSize) PublishedReaderStripe {
+  std::atomic<intptr_t> readers_[2] = {};
+};
+
+constexpr size_t kPublishedReaderStripes = 16;
+
+inline size_t PublishedReaderStripeIndex() noexcept {
+  static thread_local const size_t stripe =
+      std::hash<std::thread::id>()(std::this_thread::get_id()) % kPublishedReaderStripes;
+  return stripe;
+}
+
+}  // namespace details_
+
+// Single writer, many readers publishing of a small array (config/routing tables)
+//
+// Inline sized contents (<= BufferSize) live in the object behind a seqlock: readers copy them
+// and retry if the writer was active meanwhile.
+// Spilled contents are published as an immutable heap buffer; readers pin it by entering the
+// current epoch (striped counters), the writer frees a replaced buffer once the epoch it was
+// visible in has no readers left.
+// Readers never block nor allocate (they only retry), the writer waits for readers of the
+// buffer it replaces.
+//
+// Concurrency: one thread may publish(), any number of threads may snapshot()
+template <
+  typename DataType,
+  size_t BufferSize,
+  typename Allocator = std::allocator<DataType>
+>
+class PublishedSBOVector {
+  static_assert(std::is_trivially_copyable_v<DataType>,
+                "seqlock readers copy DataType while it may be overwritten");
+
+  struct External {
+    DataType* data_;
+    size_t count_;
+  };
+
+  std::atomic<uint64_t> sequence_;
+  std::atomic<size_t> count_;
+  std::atomic<External*> external_;
+  std::array<details_::AlignedStorage<DataType>, BufferSize> inline_;
+  std::atomic<uint64_t> epoch_;
+  mutable std::array<details_::PublishedReaderStripe, details_::kPublishedReaderStripes> stripes_;
+  Allocator alloc_;
+
+  // returns the entered stripe counter, pins every external_ loaded until leave()
+  std::atomic<intptr_t>* enter() const noexcept {
+    auto& stripe = stripes_[details_::PublishedReaderStripeIndex()];
+    while (true) {
+      const auto epoch = epoch_.load();
+      auto& readers = stripe.readers_[epoch & 1];
+      readers.fetch_add(1);
+      if (epoch_.load() == epoch) {
+        return &readers;
+      }
+      // the writer flipped the epoch in between, it may not have seen us
+      readers.fetch_sub(1);
+    }
+  }
+
+  static void leave(std::atomic<intptr_t>* readers) noexcept {
+    readers->fetch_sub(1, std::memory_order_release);
+  }
+
+  // waits until no reader can still hold a pointer loaded before this call
+  void synchronize() noexcept {
+    const auto parity = epoch_.fetch_add(1) & 1;
+    for (const auto& stripe : stripes_) {
+      while (stripe.readers_[parity].load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+      }
+    }
+  }
+
+  void free_external(External* external) noexcept {
+    alloc_.deallocate(external->data_, external->count_);
+    delete external;
+  }
+
+  // writer only, readers retry while sequence_ is odd
+  template <typename Fn>
+  void write_locked(Fn&& fn) noexcept {
+    const auto sequence = sequence_.load(std::memory_order_relaxed);
+    sequence_.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    fn();
+    sequence_.store(sequence + 2, std::memory_order_release);
+  }
+
+ public:
+  using value_type = DataType;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+
+  // A consistent view of the contents at snapshot() time, valid for its lifetime
+  // (inline contents are copied, spilled contents are pinned)
+  class Snapshot {
+    friend class PublishedSBOVector;
+
+    std::array<details_::AlignedStorage<DataType>, BufferSize> copy_;
+    const DataType* data_;
+    size_t count_;
+    std::atomic<intptr_t>* pinned_;
+
+    explicit Snapshot(const PublishedSBOVector& source) noexcept : pinned_(nullptr) {
+      auto copy = reinterpret_cast<DataType*>(copy_.data());
+      while (true) {
+        const auto sequence = source.sequence_.load(std::memory_order_acquire);
+        if (sequence & 1) {
+          continue;
+        }
+        if (source.external_.load(std::memory_order_relaxed)) {
+          pinned_ = source.enter();
+          if (auto external = source.external_.load()) {
+            data_ = external->data_;
+            count_ = external->count_;
+            return;
+          }
+          // went back inline meanwhile
+          leave(pinned_);
+          pinned_ = nullptr;
+          continue;
+        }
+        count_ = source.count_.load(std::memory_order_relaxed);
+        // racy copy, only used if the sequence did not change
+        std::memcpy(static_cast<void*>(copy), source.inline_.data(),
+                    std::min(count_, BufferSize) * sizeof(DataType));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (source.sequence_.load(std::memory_order_relaxed) == sequence) {
+          data_ = copy;
+          return;
+        }
+      }
+    }
+
+   public:
+    Snapshot(const Snapshot&) = delete;
+    Snapshot& operator=(const Snapshot&) = delete;
+    ~Snapshot() {
+      if (pinned_) {
+        leave(pinned_);
+      }
+    }
+
+    [[nodiscard]] const DataType* data() const noexcept { return data_; }
+    [[nodiscard]] size_t size() const noexcept { return count_; }
+    [[nodiscard]] bool empty() const noexcept { return count_ == 0; }
+    [[nodiscard]] const DataType* begin() const noexcept { return data_; }
+    [[nodiscard]] const DataType* end() const noexcept { return data_ + count_; }
+    [[nodiscard]] const DataType& operator[](size_t index) const noexcept { return data_[index]; }
+  };
+
+  PublishedSBOVector() noexcept : PublishedSBOVector(Allocator()) {}
+
+  explicit PublishedSBOVector(const Allocator& alloc) noexcept
+      : sequence_(0), count_(0), external_(nullptr), epoch_(0), alloc_(alloc) {}
+
+  PublishedSBOVector(const PublishedSBOVector&) = delete;
+  PublishedSBOVector& operator=(const PublishedSBOVector&) = delete;
+
+  // requires no live Snapshot
+  ~PublishedSBOVector() {
+    if (auto external = external_.load()) {
+      free_external(external);
+    }
+  }
+
+  // Reader: never blocks (retries while the writer is mid update) and never allocates
+  [[nodiscard]] Snapshot snapshot() const noexcept { return Snapshot(*this); }
+
+  // Writer: replaces the contents, waits for readers still pinning replaced spilled contents
+  void publish(const DataType* values, size_t count) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    External* created = nullptr;
+    if (count > BufferSize) {
+      auto data = alloc_.allocate(count);
+      if (!data) {
+        SBOVECTOR_ASSERT(!SBOVECTOR_SHOULD_THROW_BAD_ALLOC, SBOVEC_OOM);
+        SBOVECTOR_DO_BAD_ALLOC_THROW();
+      }
+      std::uninitialized_copy_n(values, count, data);
+      created = new External{data, count};
+    }
+    auto replaced = external_.load(std::memory_order_relaxed);
+    write_locked([&]() {
+      if (!created) {
+        std::memcpy(static_cast<void*>(inline_.data()), values, count * sizeof(DataType));
+      }
+      count_.store(count, std::memory_order_relaxed);
+      external_.store(created);
+    });
+    if (replaced) {
+      synchronize();
+      free_external(replaced);
+    }
+  }
+
+  template <typename Container>
+  void publish(const Container& values) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    publish(values.data(), values.size());
+  }
+};
+
+#endif  // PUBLISHED_SBOVECTOR_HPP
@@ -0,0 +1,103 @@
+#include "unittest_common.hpp"
+
+#include "published_sbovector.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+// Unittests for PublishedSBOVector
+
+TEST(ValueVerifiedPublishedSBOVector, MustPublishInlineAndSpilled) {
+  CountingAllocator<int>::Totals totals;
+  {
+    PublishedSBOVector<int, SBO_SIZE, CountingAllocator<int>> published{
+      CountingAllocator<int>(&totals)};
+    EXPECT_TRUE(published.snapshot().empty());
+
+    const auto small = make_vector_sequence<SMALL_SIZE>();
+    const auto large = make_vector_sequence<LARGE_SIZE>();
+    published.publish(small);
+    EXPECT_RANGE_EQ(published.snapshot(), small);
+    EXPECT_EQ(totals.allocs_, 0);
+
+    published.publish(large);
+    EXPECT_RANGE_EQ(published.snapshot(), large);
+    EXPECT_EQ(totals.allocs_, 1);
+
+    // replaced spilled contents are reclaimed
+    published.publish(large);
+    EXPECT_EQ(totals.allocs_, 2);
+    EXPECT_EQ(totals.frees_, 1);
+
+    published.publish(small.data(), SMALL_SIZE);
+    EXPECT_RANGE_EQ(published.snapshot(), small);
+    EXPECT_EQ(totals.frees_, 2);
+    published.publish(large);
+  }
+  EXPECT_EQ(totals.allocs_, totals.frees_);
+}
+
+TEST(ValueVerifiedPublishedSBOVector, MustKeepSnapshotAliveAcrossPublish) {
+  PublishedSBOVector<int, SBO_SIZE> published;
+  const auto large = make_vector_sequence<LARGE_SIZE>();
+  published.publish(large);
+
+  std::atomic<bool> republished{false};
+  std::thread writer;
+  {
+    const auto snapshot = published.snapshot();
+    writer = std::thread([&]() {
+      published.publish(large.data(), SBO_SIZE + 1);
+      republished = true;
+    });
+    // the writer cannot reclaim the pinned buffer
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(republished.load());
+    EXPECT_RANGE_EQ(snapshot, large);
+  }
+  writer.join();
+  EXPECT_TRUE(republished.load());
+  EXPECT_EQ(published.snapshot().size(), SBO_SIZE + 1);
+}
+
+TEST(ValueVerifiedPublishedSBOVector, MustReadConsistentSnapshotsConcurrently) {
+  constexpr int kReaders = 4;
+  constexpr int kVersions = 20000;
+  PublishedSBOVector<int, SBO_SIZE> published;
+  std::atomic<bool> done{false};
+  std::atomic<int> errors{0};
+
+  // every version is (version % 2 * LARGE_SIZE + version % SBO_SIZE + 1) copies of version
+  std::vector<std::thread> readers;
+  for (auto r = 0; r < kReaders; ++r) {
+    readers.emplace_back([&]() {
+      while (!done.load()) {
+        const auto snapshot = published.snapshot();
+        if (snapshot.empty()) {
+          continue;
+        }
+        const auto version = snapshot[0];
+        const auto expected_size = static_cast<size_t>(
+          version % 2 * static_cast<int>(LARGE_SIZE) + version % static_cast<int>(SBO_SIZE) + 1);
+        if (snapshot.size() != expected_size ||
+            std::any_of(snapshot.begin(), snapshot.end(), [version](int v) { return v != version; })) {
+          ++errors;
+        }
+        std::this_thread::yield();
+      }
+    });
+  }
+  std::vector<int> values;
+  for (auto version = 0; version < kVersions; ++version) {
+    values.assign(static_cast<size_t>(version % 2 * static_cast<int>(LARGE_SIZE) +
+                                      version % static_cast<int>(SBO_SIZE) + 1),
+                  version);
+    published.publish(values);
+  }
+  done = true;
+  for (auto& reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(errors.load(), 0);
+}
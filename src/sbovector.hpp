@@ -6,6 +6,7 @@
 #ifndef SBOVECTOR_ASSERT
 #include <cassert>
 #endif
+#include <cstring>
 #include <exception>
 #include <initializer_list>
 #include <memory>
@@ -20,6 +21,71 @@
 
 #define SBOVECTOR_NOEXCEPT_COND_ALLOC noexcept(!SBOVECTOR_SHOULD_THROW_BAD_ALLOC)
 
+// if true: every SBOVector counts its storage transitions into SBOVectorStats
+// (include sbovector_stats.hpp to dump them), see sbovector_stats_policy
+#ifndef SBOVECTOR_ENABLE_STATS
+#define SBOVECTOR_ENABLE_STATS false
+#endif
+
+// if true: every SBOVector records its size profile into SBOVectorProfile, a BufferSize
+// report is written at exit (see sbovector_profile.hpp), takes precedence over stats
+#ifndef SBOVECTOR_ENABLE_PROFILE
+#define SBOVECTOR_ENABLE_PROFILE false
+#endif
+
+// Static tracepoints, provider "sbovector" (see tools/bpftrace), each with the arguments:
+//   element size, old count, new count, old capacity, new capacity, BufferSize, moved
+// (moved: elements moved into the new storage, 0 when the allocator relocated the buffer
+// itself (see has_reallocate) or a buffer was handed over as is, same as the stats hooks)
+// on grow (insert_unninitialized_with_growth), reserve, shrink_to_fit, internalize,
+// one_alloc_swap, two_alloc_swap (both sides of swap_cross allocating) and hand_over_swap
+// (both sides of a spilled vector's buffer going to an inline one)
+// USDT probes if SBOVECTOR_ENABLE_USDT is defined (requires sys/sdt.h), otherwise compiled out
+// unless SBOVECTOR_PROBE(name, ...) is defined before this header (eg: a test tracer)
+#ifndef SBOVECTOR_PROBE
+#ifdef SBOVECTOR_ENABLE_USDT
+#include <sys/sdt.h>
+#define SBOVECTOR_PROBE(name, ...) STAP_PROBE7(sbovector, name, __VA_ARGS__)
+#else
+#define SBOVECTOR_PROBE(name, ...) static_cast<void>(0)
+#endif
+#endif
+
+// Stats policy hooks, the disabled policy: all static and empty so it never changes
+// sizeof(SBOVector) nor the generated code
+// (a policy is an (empty) base of the vector, it may hold per vector state)
+struct SBOVectorNoStats {
+  // size() about to increase to new_size
+  static constexpr void on_grow(size_t /*new_size*/) noexcept {}
+  // inline_ -> external_ (moved: elements relocated)
+  static constexpr void on_spill(size_t /*new_size*/, size_t /*moved*/, size_t /*new_capacity*/) noexcept {}
+  // external_ -> new external_ (growth or shrink_to_fit)
+  static constexpr void on_reallocate(size_t /*new_size*/, size_t /*moved*/, size_t /*new_capacity*/) noexcept {}
+  // external_ -> inline_
+  static constexpr void on_internalize(size_t /*moved*/) noexcept {}
+  static constexpr void on_destroy(size_t /*size*/) noexcept {}
+};
+
+template <typename DataType, size_t BufferSize, typename Allocator, bool Compact>
+struct SBOVectorStats;
+
+template <typename DataType, size_t BufferSize, typename Allocator, bool Compact>
+class SBOVectorProfile;
+
+// Stats policy of one SBOVector instantiation: specialize to instrument only some of them
+template <typename DataType, size_t BufferSize, typename Allocator, bool Compact>
+struct sbovector_stats_policy {
+  using type = std::conditional_t<
+    SBOVECTOR_ENABLE_PROFILE,
+    SBOVectorProfile<DataType, BufferSize, Allocator, Compact>,
+    std::conditional_t<
+      SBOVECTOR_ENABLE_STATS,
+      SBOVectorStats<DataType, BufferSize, Allocator, Compact>,
+      SBOVectorNoStats
+    >
+  >;
+};
+
 namespace details_ {
 
 // throw within a noexcept is a call to terminate
@@ -77,6 +143,31 @@ struct is_iterator<
 template <typename T>
 constexpr bool is_iterator_v = is_iterator<T>::value;
 
+// Allocators may optionally provide pointer reallocate(pointer, old_capacity, new_capacity)
+// to grow an allocation without a copy and free (eg: mremap), the contents are
+// relocated bitwise so it is only used for trivially copyable DataType
+template <typename T, typename = void>
+struct has_reallocate {
+  static constexpr bool value = false;
+};
+
+template <typename T>
+struct has_reallocate<
+  T,
+  std::void_t<
+    decltype(std::declval<T&>().reallocate(
+      std::declval<typename std::allocator_traits<T>::pointer>(),
+      size_t{},
+      size_t{}
+    ))
+  >
+> {
+  static constexpr bool value = true;
+};
+
+template <typename T>
+constexpr bool has_reallocate_v = has_reallocate<T>::value;
+
 template<typename T>
 using AlignedStorage = std::aligned_storage_t<sizeof(T), alignof(T)>;
 
@@ -303,8 +394,10 @@ struct SBOVectorBase<DataType, BufferSize, Allocator, Compact, false>
 // looking at method signatures
 template <typename DataType, size_t BufferSize, typename Allocator, bool Compact>
 struct VectorImpl final
-    : public SBOVectorBase<DataType, BufferSize, Allocator, Compact> {
+    : public SBOVectorBase<DataType, BufferSize, Allocator, Compact>,
+      private sbovector_stats_policy<DataType, BufferSize, Allocator, Compact>::type {
   using BaseType = SBOVectorBase<DataType, BufferSize, Allocator, Compact>;
+  using Stats = typename sbovector_stats_policy<DataType, BufferSize, Allocator, Compact>::type;
 
   using BaseType::get_allocator;
   using BaseType::capacity;
@@ -314,7 +407,21 @@ struct VectorImpl final
   VectorImpl() : BaseType() {}
   VectorImpl(const Allocator& alloc) : BaseType(alloc) {}
 
-  ~VectorImpl() { clear(); }
+  ~VectorImpl() {
+    stats().on_destroy(count());
+    clear();
+  }
+
+  Stats& stats() noexcept { return *this; }
+
+  // count a new buffer replacing the current storage (inline: a spill)
+  void record_new_buffer(size_t new_size, size_t moved, size_t new_capacity) noexcept {
+    if (count() <= BufferSize) {
+      stats().on_spill(new_size, moved, new_capacity);
+    } else {
+      stats().on_reallocate(new_size, moved, new_capacity);
+    }
+  }
 
   DataType* begin() {
     return data();
@@ -356,6 +463,26 @@ struct VectorImpl final
     this->set_count(count() + insert_count);
   }
 
+  static constexpr bool kCanReallocate =
+      has_reallocate_v<Allocator> && std::is_trivially_copyable_v<DataType>;
+
+  // elements growth moves into a new buffer (none when the allocator relocates external_)
+  size_t moved_on_growth() const noexcept {
+    return (kCanReallocate && count() > BufferSize) ? 0 : count();
+  }
+
+  // grow external_ through Allocator::reallocate, see has_reallocate
+  DataType* reallocate_external(size_t new_cap) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    auto new_buffer =
+        this->access_allocator().reallocate(data(), capacity(), new_cap);
+    if (!new_buffer) {
+      SBOVECTOR_ASSERT(!SBOVECTOR_SHOULD_THROW_BAD_ALLOC, SBOVEC_OOM);
+      SBOVECTOR_DO_BAD_ALLOC_THROW();
+    }
+    this->set_external(new_buffer, new_cap);
+    return new_buffer;
+  }
+
   void insert_unninitialized_with_growth(size_t pos, size_t insert_count)
       SBOVECTOR_NOEXCEPT_COND_ALLOC {
     static_assert(kRelaxedExceptions || std::is_nothrow_move_constructible_v<DataType>);
@@ -363,6 +490,23 @@ struct VectorImpl final
 
     const size_t new_size = count() + insert_count;
     const size_t new_cap = std::max(new_size, SuggestGrowth(count()));
+    SBOVECTOR_PROBE(grow, sizeof(DataType), count(), new_size, capacity(), new_cap, BufferSize,
+                    moved_on_growth());
+
+    if constexpr (kCanReallocate) {
+      if (count() > BufferSize) {
+        // relocated by the allocator, not counted as moved
+        stats().on_reallocate(new_size, 0, new_cap);
+        auto new_buffer = reallocate_external(new_cap);
+        std::memmove(
+          new_buffer + pos + insert_count,
+          new_buffer + pos,
+          (count() - pos) * sizeof(DataType)
+        );
+        this->set_count(new_size);
+        return;
+      }
+    }
 
     auto new_buffer = get_allocator().allocate(new_cap);
 
@@ -371,6 +515,7 @@ struct VectorImpl final
       SBOVECTOR_DO_BAD_ALLOC_THROW();
     }
 
+    record_new_buffer(new_size, count(), new_cap);
     std::uninitialized_move_n(begin(), pos, new_buffer);
     std::uninitialized_move_n(
       begin() + pos,
@@ -393,6 +538,16 @@ struct VectorImpl final
         size_t pos,
         size_t insert_count
       ) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    stats().on_grow(count() + insert_count);
+    insert_unninitialized_unrecorded(pos, insert_count);
+  }
+
+  // insert_unninitialized without reporting the size to on_grow
+  // (for callers that may drop part of the space again, they report the size they keep)
+  void insert_unninitialized_unrecorded(
+        size_t pos,
+        size_t insert_count
+      ) SBOVECTOR_NOEXCEPT_COND_ALLOC {
     if (count() + insert_count <= capacity()) {
       insert_unninitialized_in_cap(pos, insert_count);
     } else {
@@ -406,8 +561,11 @@ struct VectorImpl final
   void internalize() noexcept {
     static_assert(kRelaxedExceptions || std::is_nothrow_move_constructible_v<DataType>);
 
+    stats().on_internalize(count());
     auto external_ptr_copy = this->external_data();
     auto external_capacity_copy = this->external_capacity();
+    SBOVECTOR_PROBE(internalize, sizeof(DataType), count(), count(), external_capacity_copy,
+                    BufferSize, BufferSize, count());
 
     this->prep_change_to_inline();
 
@@ -450,6 +608,43 @@ struct VectorImpl final
     B.set_count(a_count);
   }
 
+  // external's buffer goes to inlined as is, inlined's elements move into external's
+  // inline buffer (eg: move construction from a spilled vector: no allocation, no moves)
+  // assumes the allocators compare equal, inlined.count() fits external's inline buffer and
+  // external.count() does not fit inlined's
+  template <
+    size_t Size1,
+    bool Compact1,
+    size_t Size2,
+    bool Compact2
+  >
+  inline static void hand_over_external(
+      VectorImpl<DataType, Size1, Allocator, Compact1>& external,
+      VectorImpl<DataType, Size2, Allocator, Compact2>& inlined) noexcept {
+    static_assert(kRelaxedExceptions || std::is_nothrow_move_constructible_v<DataType>);
+
+    const auto buffer = external.external_data();
+    const auto buffer_capacity = external.external_capacity();
+    const auto external_count = external.count();
+    const auto inlined_count = inlined.count();
+    SBOVECTOR_PROBE(hand_over_swap, sizeof(DataType), external_count, inlined_count,
+                    buffer_capacity, Size1, Size1, inlined_count);
+    SBOVECTOR_PROBE(hand_over_swap, sizeof(DataType), inlined_count, external_count, Size2,
+                    buffer_capacity, Size2, size_t{0});
+    // external: an internalization of inlined's elements, inlined: a spill moving none
+    external.stats().on_internalize(inlined_count);
+    inlined.stats().on_spill(external_count, 0, buffer_capacity);
+
+    external.prep_change_to_inline();
+    external.set_count(inlined_count);
+    std::uninitialized_move_n(inlined.begin(), inlined_count, external.begin());
+    std::destroy_n(inlined.begin(), inlined_count);
+
+    inlined.prep_change_to_external();
+    inlined.set_count(external_count);
+    inlined.set_external(buffer, buffer_capacity);
+  }
+
   template <
     size_t Size1,
     typename Allocator1,
@@ -465,12 +660,15 @@ struct VectorImpl final
     static_assert(kRelaxedExceptions || std::is_nothrow_move_constructible_v<DataType>);
 
     auto new_data_size = remaining.count();
+    SBOVECTOR_PROBE(one_alloc_swap, sizeof(DataType), allocating.count(), new_data_size,
+                    allocating.capacity(), new_data_size, Size1, new_data_size);
     auto new_data = allocating.access_allocator().allocate(new_data_size);
 
     if (!new_data) {
       SBOVECTOR_ASSERT(!SBOVECTOR_SHOULD_THROW_BAD_ALLOC, SBOVEC_OOM);
       SBOVECTOR_DO_BAD_ALLOC_THROW();
     }
+    allocating.record_new_buffer(new_data_size, new_data_size, new_data_size);
     std::uninitialized_move_n(remaining.begin(), new_data_size, new_data);
     std::destroy(remaining.begin(), remaining.end());
     std::uninitialized_move_n(
@@ -513,6 +711,10 @@ struct VectorImpl final
     } else if (that_is_sufficient) {
       one_alloc_swap(*this, that);
     } else {
+      SBOVECTOR_PROBE(two_alloc_swap, sizeof(DataType), count(), that.count(), capacity(),
+                      that.count(), BufferSize, that.count());
+      SBOVECTOR_PROBE(two_alloc_swap, sizeof(DataType), that.count(), count(), that.capacity(),
+                      count(), OtherSize, count());
       auto new_this_size = that.count();
       auto new_this = this->access_allocator().allocate(that.count());
 
@@ -530,6 +732,8 @@ struct VectorImpl final
         SBOVECTOR_DO_BAD_ALLOC_THROW();
       }
 
+      record_new_buffer(new_this_size, new_this_size, new_this_size);
+      that.record_new_buffer(new_that_size, new_that_size, new_that_size);
       std::uninitialized_move_n(that.begin(), that.count(), new_this);
       std::uninitialized_move_n(begin(), count(), new_that);
 
@@ -574,6 +778,12 @@ struct VectorImpl final
       if (that_will_be_inline) {
         that.internalize();
       }
+    } else if (this_is_inline && !that_is_inline && can_swap_external
+            && !this_will_be_inline && that_will_be_inline) {
+      hand_over_external(that, *this);
+    } else if (that_is_inline && !this_is_inline && can_swap_external
+            && !that_will_be_inline && this_will_be_inline) {
+      hand_over_external(*this, that);
     } else if (this_is_inline && that_is_inline 
             && this_will_be_inline && that_will_be_inline) {
       no_alloc_swap(*this, that);
@@ -590,13 +800,26 @@ struct VectorImpl final
     // immediately.
     static_assert(kRelaxedExceptions || std::is_nothrow_move_assignable_v<DataType>);
 
+    // (callers reserve for the size they are about to reach)
+    const auto new_size = new_capacity;
     new_capacity = std::max(new_capacity, SuggestGrowth(count()));
+    SBOVECTOR_PROBE(reserve, sizeof(DataType), count(), new_size, capacity(), new_capacity,
+                    BufferSize, moved_on_growth());
+
+    if constexpr (kCanReallocate) {
+      if (count() > BufferSize) {
+        stats().on_reallocate(new_size, 0, new_capacity);
+        reallocate_external(new_capacity);
+        return;
+      }
+    }
 
     auto new_data = this->access_allocator().allocate(new_capacity);
     if (!new_data) {
       SBOVECTOR_ASSERT(!SBOVECTOR_SHOULD_THROW_BAD_ALLOC, SBOVEC_OOM);
       SBOVECTOR_DO_BAD_ALLOC_THROW();
     }
+    record_new_buffer(new_size, count(), new_capacity);
 
     std::uninitialized_move_n(begin(), count(), new_data);
     std::destroy(begin(), end());
@@ -615,11 +838,14 @@ struct VectorImpl final
     // requires count() < capacity()
     static_assert(kRelaxedExceptions || std::is_nothrow_move_assignable_v<DataType>);
 
+    SBOVECTOR_PROBE(shrink_to_fit, sizeof(DataType), count(), count(), capacity(), count(),
+                    BufferSize, count());
     auto new_data = get_allocator().allocate(count());
     if (!new_data) {
       SBOVECTOR_ASSERT(!SBOVECTOR_SHOULD_THROW_BAD_ALLOC, SBOVEC_OOM);
       SBOVECTOR_DO_BAD_ALLOC_THROW();
     }
+    stats().on_reallocate(count(), count(), count());
 
     std::uninitialized_move_n(begin(), count(), new_data);
     std::destroy(begin(), end());
@@ -628,6 +854,17 @@ struct VectorImpl final
     this->set_external(new_data, count());
   }
 
+  // drop trailing elements without destroying them (trivial DataType only)
+  void truncate_trivial(size_t new_count) noexcept {
+    static_assert(std::is_trivially_destructible_v<DataType>);
+
+    const auto must_internalize =
+        (count() > BufferSize) && (new_count <= BufferSize);
+    this->set_count(new_count);
+    if (must_internalize)
+      internalize();
+  }
+
   DataType* erase(const DataType* pos, size_t p_count) noexcept {
     static_assert(kRelaxedExceptions || std::is_nothrow_move_assignable_v<DataType>);
 
@@ -645,6 +882,7 @@ struct VectorImpl final
   template <typename... Args>
   DataType& emplace_back(Args&&... args) SBOVECTOR_NOEXCEPT_COND_ALLOC {
     static_assert(kRelaxedExceptions || std::is_nothrow_constructible_v<DataType, Args...>);
+    stats().on_grow(count() + 1);
     if (count() == capacity()) {
       reserve(count() + 1);
     }
@@ -771,7 +1009,8 @@ class SBOVector {
     swap(move_from);
   }
 
-  ~SBOVector() { clear(); }
+  // (impl_ clears, after reporting the final size to its Stats policy)
+  ~SBOVector() = default;
 
   SBOVector& operator=(const SBOVector& other) SBOVECTOR_NOEXCEPT_COND_ALLOC {
     assign(other.begin(), other.end());
@@ -949,9 +1188,8 @@ class SBOVector {
     static_assert(details_::kRelaxedExceptions || std::is_nothrow_copy_constructible_v<DataType>);
     const auto i_pos = static_cast<size_t>(std::distance(cbegin(), pos));
     impl_.insert_unninitialized(i_pos, static_cast<size_t>(std::distance(p_begin, p_end)));
-    for (auto iter = begin() + i_pos; p_begin != p_end; ++p_begin, ++iter) {
-      new (iter) DataType(*p_begin);
-    }
+    // uninitialized_copy degrades to memmove for trivially copyable contiguous ranges
+    std::uninitialized_copy(p_begin, p_end, begin() + i_pos);
     return begin() + i_pos;
   }
 
@@ -993,6 +1231,23 @@ class SBOVector {
 
   void pop_back() noexcept { erase(begin() + size() - 1); }
 
+  // Appends up to max_count elements written in place by
+  //   fill(pointer uninitialized_tail, size_t max_count) -> size_t written (<= max_count)
+  // storage is grown once before fill is called, unwritten space is dropped after,
+  // this avoids the value initialization of resize() for buffers filled by eg: read()
+  // or memcpy (trivially copyable DataType: fill may write the object representation)
+  // returns written
+  template <typename Fill>
+  size_t append_uninitialized(size_t max_count, Fill&& fill) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    static_assert(std::is_trivially_copyable_v<DataType>);
+    const auto old_size = size();
+    impl_.insert_unninitialized_unrecorded(old_size, max_count);
+    const size_t written = std::min<size_t>(fill(begin() + old_size, max_count), max_count);
+    impl_.stats().on_grow(old_size + written);
+    impl_.truncate_trivial(old_size + written);
+    return written;
+  }
+
   void resize(size_t count) SBOVECTOR_NOEXCEPT_COND_ALLOC {
     static_assert(details_::kRelaxedExceptions || std::is_nothrow_default_constructible_v<DataType>);
     auto old_size = size();
@@ -1032,9 +1287,50 @@ class SBOVector {
 
   template<typename DataType_, size_t BufferSize_, typename Allocator_, bool Compact_>
   friend class SBOVector;
+
+ private:
+  // CowSBOVector keeps spilled contents in its shared buffer header between mutations,
+  // these hand a spilled buffer over without moving elements
+
+  // assumes size() == 0, p_data was allocated (for capacity elements) by get_allocator()
+  // and count > BufferSize
+  void adopt_external(DataType* p_data, size_t count, size_t capacity) noexcept {
+    impl_.prep_change_to_external();
+    impl_.set_count(count);
+    impl_.set_external(p_data, capacity);
+  }
+
+  // assumes size() > BufferSize, leaves this empty
+  DataType* release_external() noexcept {
+    auto p_data = impl_.external_data();
+    impl_.prep_change_to_inline();
+    impl_.set_count(0);
+    return p_data;
+  }
+
+  // copies count (> BufferSize) elements into this (empty), one allocation with room for
+  // at least min_capacity elements
+  void copy_reserved(const DataType* p_begin, size_t count, size_t min_capacity)
+      SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    static_assert(details_::kRelaxedExceptions || std::is_nothrow_copy_constructible_v<DataType>);
+    impl_.stats().on_grow(count);
+    // leaves an empty external buffer, valid again once count is set
+    impl_.reserve(std::max(count, min_capacity));
+    impl_.set_count(count);
+    std::uninitialized_copy_n(p_begin, count, begin());
+  }
+
+  template <typename DataType_, size_t BufferSize_, typename Allocator_, bool Compact_>
+  friend class CowSBOVector;
 };
 
 template<typename DataType, size_t BufferSize, typename Allocator = std::allocator<DataType>>
 using CompactSBOVector = SBOVector<DataType, BufferSize, Allocator, true>;
 
+#if SBOVECTOR_ENABLE_PROFILE
+#include "sbovector_profile.hpp"
+#elif SBOVECTOR_ENABLE_STATS
+#include "sbovector_stats.hpp"
+#endif
+
 #endif  // SBOVECTOR_HPP
\ No newline at end of file
@@ -0,0 +1,216 @@
+#ifndef SBOVECTOR_COMPACTION_HPP
+#define SBOVECTOR_COMPACTION_HPP
+
+#include "sbovector.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+// Compaction of the spill buffers of a long lived collection of SBOVectors into one slab
+//
+// Vectors allocate through CompactingAllocator<T>, which points to a CompactionState shared by
+// every vector of the collection. Until compacted it is std::allocator; compact_collection
+// moves every spilled vector into one exactly sized slab owned by the state, at exact capacity.
+// Buffers released from a slab are not reused, a slab is freed once its last buffer is released.
+// The owner of the collection owns the state, which must outlive every vector using it
+// (like SlabArena). Not thread safe: the state is shared like the collection itself.
+
+// Shared (by the allocators of one collection) slab bookkeeping, type erased
+class CompactionState {
+  struct Slab {
+    std::unique_ptr<std::max_align_t[]> memory_;
+    std::byte* begin_;
+    std::byte* end_;
+    size_t live_;
+  };
+
+  std::vector<Slab> slabs_;
+  // during compact_collection: bump allocation through the newest slab
+  std::byte* cursor_ = nullptr;
+  std::byte* cursor_end_ = nullptr;
+
+ public:
+  CompactionState() = default;
+  CompactionState(const CompactionState&) = delete;
+  CompactionState& operator=(const CompactionState&) = delete;
+
+  [[nodiscard]] size_t slab_count() const noexcept { return slabs_.size(); }
+
+  // Starts bump allocating from a new slab of bytes, false on allocation failure
+  bool begin_compaction(size_t bytes) noexcept {
+    const auto words = (bytes + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+    std::unique_ptr<std::max_align_t[]> memory(new (std::nothrow) std::max_align_t[words]);
+    if (!memory) {
+      return false;
+    }
+    auto begin = static_cast<std::byte*>(static_cast<void*>(memory.get()));
+    slabs_.push_back({std::move(memory), begin, begin + bytes, 0});
+    cursor_ = begin;
+    cursor_end_ = begin + bytes;
+    return true;
+  }
+
+  void end_compaction() noexcept {
+    cursor_ = cursor_end_ = nullptr;
+    // nothing was relocated into it
+    if (!slabs_.empty() && slabs_.back().live_ == 0) {
+      slabs_.pop_back();
+    }
+  }
+
+  // nullptr unless compacting and the slab has room
+  void* bump(size_t bytes, size_t alignment) noexcept {
+    if (!cursor_) {
+      return nullptr;
+    }
+    const auto misalignment = static_cast<size_t>(cursor_ - slabs_.back().begin_) % alignment;
+    const auto start = misalignment ? cursor_ + (alignment - misalignment) : cursor_;
+    if (start > cursor_end_ || static_cast<size_t>(cursor_end_ - start) < bytes) {
+      return nullptr;
+    }
+    cursor_ = start + bytes;
+    ++slabs_.back().live_;
+    return start;
+  }
+
+  // true if p was allocated from a slab (which is freed with its last buffer)
+  bool release(const void* p) noexcept {
+    const auto byte = static_cast<const std::byte*>(p);
+    for (auto slab = slabs_.begin(); slab != slabs_.end(); ++slab) {
+      if (byte >= slab->begin_ && byte < slab->end_) {
+        if (--slab->live_ == 0 && !(cursor_ && slab + 1 == slabs_.end())) {
+          slabs_.erase(slab);
+        }
+        return true;
+      }
+    }
+    return false;
+  }
+};
+
+// std::allocator until its CompactionState holds slabs, see compact_collection
+// Allocators are equal when they share a CompactionState (default constructed: none)
+// One pointer: copies (eg: get_allocator()) touch no reference count
+template <typename T>
+struct CompactingAllocator {
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using size_type = size_t;
+
+  using is_always_equal = std::false_type;
+
+  template <typename U>
+  struct rebind {
+    using other = CompactingAllocator<U>;
+  };
+
+  CompactionState* state_ = nullptr;
+
+  CompactingAllocator() noexcept = default;
+
+  explicit CompactingAllocator(CompactionState& state) noexcept : state_(&state) {}
+
+  template <typename U>
+  CompactingAllocator(const CompactingAllocator<U>& other) noexcept : state_(other.state_) {}
+
+  pointer allocate(size_t n, const void*) { return allocate(n); }
+  pointer allocate(size_t n) {
+    if (state_) {
+      if (auto p = state_->bump(n * sizeof(T), alignof(T))) {
+        return static_cast<pointer>(p);
+      }
+    }
+    return std::allocator<T>().allocate(n);
+  }
+
+  void deallocate(pointer p, size_t n) noexcept {
+    if (state_ && state_->release(p)) {
+      return;
+    }
+    std::allocator<T>().deallocate(p, n);
+  }
+
+  template <typename U>
+  bool operator==(const CompactingAllocator<U>& other) const noexcept {
+    return state_ == other.state_;
+  }
+  template <typename U>
+  bool operator!=(const CompactingAllocator<U>& other) const noexcept {
+    return state_ != other.state_;
+  }
+};
+
+namespace details_ {
+
+template <typename Vector>
+struct sbovector_buffer_size;
+
+template <typename DataType, size_t BufferSize, typename Allocator, bool Compact>
+struct sbovector_buffer_size<SBOVector<DataType, BufferSize, Allocator, Compact>> {
+  static constexpr size_t value = BufferSize;
+};
+
+template <typename Vector>
+constexpr size_t sbovector_buffer_size_v = sbovector_buffer_size<Vector>::value;
+
+}  // namespace details_
+
+// Relocates every spilled vector of range (SBOVectors using CompactingAllocator) sharing the
+// CompactionState of the first spilled one into a single slab of exactly the total spill size,
+// each at capacity() == size(); inline vectors and vectors of another state are left alone.
+// Elements are moved, iterators/pointers into spilled vectors are invalidated.
+// Returns the slab size in bytes (0 if nothing was relocated)
+template <typename Range>
+size_t compact_collection(Range& range) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+  using Vector = std::remove_reference_t<decltype(*std::begin(range))>;
+  using DataType = typename Vector::value_type;
+  constexpr auto kBufferSize = details_::sbovector_buffer_size_v<Vector>;
+
+  CompactionState* state = nullptr;
+  size_t bytes = 0;
+  for (auto& vector : range) {
+    if (vector.size() <= kBufferSize) {
+      continue;
+    }
+    const auto vector_state = vector.get_allocator().state_;
+    if (!state) {
+      state = vector_state;
+      if (!state) {
+        return 0;
+      }
+    }
+    if (vector_state == state) {
+      bytes += vector.size() * sizeof(DataType);
+    }
+  }
+  if (bytes == 0) {
+    return 0;
+  }
+  if (!state->begin_compaction(bytes)) {
+    SBOVECTOR_ASSERT(!SBOVECTOR_SHOULD_THROW_BAD_ALLOC, SBOVEC_OOM);
+    SBOVECTOR_DO_BAD_ALLOC_THROW();
+  }
+  const typename Vector::allocator_type allocator(*state);
+  for (auto& vector : range) {
+    if (vector.size() <= kBufferSize || vector.get_allocator().state_ != state) {
+      continue;
+    }
+    // allocated from the slab at exact size, equal allocators so swap exchanges buffers
+    Vector compacted(
+      std::make_move_iterator(vector.begin()),
+      std::make_move_iterator(vector.end()),
+      allocator
+    );
+    vector.swap(compacted);
+  }
+  state->end_compaction();
+  return bytes;
+}
+
+#endif  // SBOVECTOR_COMPACTION_HPP
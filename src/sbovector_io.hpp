@@ -0,0 +1,120 @@
+#ifndef SBOVECTOR_IO_HPP
+#define SBOVECTOR_IO_HPP
+
+#if !defined(__unix__)
+#error "sbovector_io.hpp requires POSIX read/writev"
+#endif
+
+#include "sbovector.hpp"
+
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <climits>
+#include <type_traits>
+
+// Direct file descriptor I/O into and out of SBOVector storage (byte sized DataType)
+
+namespace details_ {
+
+template <typename DataType>
+constexpr void AssertByteVector() {
+  static_assert(sizeof(DataType) == 1 && std::is_trivial_v<DataType>,
+                "fd I/O requires a byte sized trivial DataType (char, std::byte, ...)");
+}
+
+#if defined(IOV_MAX)
+constexpr size_t kMaxIOVecs = IOV_MAX;
+#else
+constexpr size_t kMaxIOVecs = 1024;
+#endif
+
+template <typename DataType, size_t BufferSize, typename Allocator, bool Compact>
+iovec ToIOVec(const SBOVector<DataType, BufferSize, Allocator, Compact>& vector) noexcept {
+  AssertByteVector<DataType>();
+  // writev never writes through iov_base
+  return {const_cast<DataType*>(vector.data()), vector.size()};
+}
+
+// writev until all of iov is written, retrying on EINTR and resuming after partial writes
+// iov is consumed (modified) in the process
+// returns bytes written: less than the total only on error (errno set), -1 if nothing was written
+inline ssize_t WritevAll(int fd, iovec* iov, size_t iov_count) noexcept {
+  ssize_t total = 0;
+  while (iov_count > 0) {
+    if (iov->iov_len == 0) {
+      ++iov;
+      --iov_count;
+      continue;
+    }
+    const auto batch = static_cast<int>(std::min(iov_count, kMaxIOVecs));
+    const auto written = writev(fd, iov, batch);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return total > 0 ? total : -1;
+    }
+    total += written;
+    auto remaining = static_cast<size_t>(written);
+    while (remaining > 0 && remaining >= iov->iov_len) {
+      remaining -= iov->iov_len;
+      ++iov;
+      --iov_count;
+    }
+    if (remaining > 0) {
+      iov->iov_base = static_cast<char*>(iov->iov_base) + remaining;
+      iov->iov_len -= remaining;
+    }
+  }
+  return total;
+}
+
+}  // namespace details_
+
+// Reads up to max_bytes from fd straight into the uninitialized tail of vector
+// (one read() call, retried on EINTR, a short read is not an error)
+// the free capacity (inline buffer or spare external space) is filled first, storage only
+// grows by max_bytes once it is exhausted: reads that fit never spill an inline vector
+// returns bytes appended, 0 on end of file, -1 on error (errno set, vector unchanged)
+template <typename DataType, size_t BufferSize, typename Allocator, bool Compact>
+ssize_t append_from_fd(
+      SBOVector<DataType, BufferSize, Allocator, Compact>& vector,
+      int fd,
+      size_t max_bytes
+    ) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+  details_::AssertByteVector<DataType>();
+  const auto spare = vector.capacity() - vector.size();
+  const auto read_count = spare > 0 ? std::min(spare, max_bytes) : max_bytes;
+  ssize_t result = 0;
+  vector.append_uninitialized(read_count, [&](DataType* tail, size_t max_count) {
+    do {
+      result = read(fd, tail, max_count);
+    } while (result < 0 && errno == EINTR);
+    return result > 0 ? static_cast<size_t>(result) : 0;
+  });
+  return result;
+}
+
+// Writes every vector, in order, with writev (no gather copy into an intermediate buffer)
+// retries on EINTR and resumes after partial writes until everything is written
+// returns bytes written: less than the total only on error (errno set), -1 if nothing was written
+template <typename... Vectors>
+ssize_t write_to_fd(int fd, const Vectors&... vectors) noexcept {
+  iovec iov[] = {details_::ToIOVec(vectors)...};
+  return details_::WritevAll(fd, iov, sizeof...(Vectors));
+}
+
+// write_to_fd for a range of SBOVectors (eg: a std::vector of pending messages)
+template <typename Iterator>
+ssize_t write_range_to_fd(int fd, Iterator first, Iterator last) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+  SBOVector<iovec, 64> iov;
+  for (; first != last; ++first) {
+    iov.push_back(details_::ToIOVec(*first));
+  }
+  return details_::WritevAll(fd, iov.data(), iov.size());
+}
+
+#endif  // SBOVECTOR_IO_HPP
@@ -0,0 +1,421 @@
+#ifndef SBOVECTOR_PARALLEL_HPP
+#define SBOVECTOR_PARALLEL_HPP
+
+#include "sbovector.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Parallel algorithms over (large, spilled) SBOVectors or any random access container
+//
+// Every algorithm has an overload taking the sbo::parallel::ThreadPool to run on first, the
+// others use default_pool(). Containers smaller than kSequentialCutoff elements (so always
+// inline ones) run the std algorithm on the calling thread.
+// The calling thread always takes part in the work, tasks must not throw.
+
+namespace sbo {
+namespace parallel {
+
+constexpr size_t kSequentialCutoff = 1 << 15;
+
+// Work stealing pool: every worker owns a deque, pops the newest task of its own deque and
+// steals the oldest task of the others when empty. Threads waiting on a TaskGroup run tasks
+// too, so nested parallelism cannot deadlock and a pool with 0 workers is valid (sequential).
+class ThreadPool {
+  using Task = std::function<void()>;
+
+  struct Queue {
+    std::mutex mutex_;
+    std::deque<Task> tasks_;
+  };
+
+  // one queue per worker, the last one takes submissions from outside the pool
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::vector<std::thread> workers_;
+  std::atomic<size_t> queued_{0};
+  std::mutex sleep_mutex_;
+  std::condition_variable wake_;
+  bool stop_{false};
+
+  // index of the calling thread's queue, the external queue for non worker threads
+  size_t own_queue() const noexcept {
+    return current_pool() == this ? current_index() : queues_.size() - 1;
+  }
+
+  static const ThreadPool*& current_pool() noexcept {
+    static thread_local const ThreadPool* pool = nullptr;
+    return pool;
+  }
+
+  static size_t& current_index() noexcept {
+    static thread_local size_t index = 0;
+    return index;
+  }
+
+  bool pop(size_t index, bool newest, Task& out) {
+    auto& queue = *queues_[index];
+    std::lock_guard<std::mutex> lock(queue.mutex_);
+    if (queue.tasks_.empty()) {
+      return false;
+    }
+    if (newest) {
+      out = std::move(queue.tasks_.back());
+      queue.tasks_.pop_back();
+    } else {
+      out = std::move(queue.tasks_.front());
+      queue.tasks_.pop_front();
+    }
+    queued_.fetch_sub(1);
+    return true;
+  }
+
+  void work(size_t index) {
+    current_pool() = this;
+    current_index() = index;
+    while (true) {
+      if (run_one()) {
+        continue;
+      }
+      std::unique_lock<std::mutex> lock(sleep_mutex_);
+      wake_.wait(lock, [this]() { return stop_ || queued_.load() > 0; });
+      if (stop_) {
+        return;
+      }
+    }
+  }
+
+ public:
+  // workers: threads owned by the pool, callers waiting on a TaskGroup help on top of them
+  explicit ThreadPool(size_t workers) {
+    for (size_t i = 0; i < workers + 1; ++i) {
+      queues_.push_back(std::make_unique<Queue>());
+    }
+    for (size_t i = 0; i < workers; ++i) {
+      workers_.emplace_back([this, i]() { work(i); });
+    }
+  }
+
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+
+  ~ThreadPool() {
+    {
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_) {
+      worker.join();
+    }
+  }
+
+  // threads working on a TaskGroup::wait() from outside the pool: workers + the caller
+  [[nodiscard]] size_t concurrency() const noexcept { return workers_.size() + 1; }
+
+  void submit(Task task) {
+    const auto index = own_queue();
+    {
+      std::lock_guard<std::mutex> lock(queues_[index]->mutex_);
+      queues_[index]->tasks_.push_back(std::move(task));
+    }
+    {
+      // under sleep_mutex_ so a worker about to sleep sees it
+      std::lock_guard<std::mutex> lock(sleep_mutex_);
+      queued_.fetch_add(1);
+    }
+    wake_.notify_one();
+  }
+
+  // runs one task: the newest of the caller's own queue, else the oldest of another queue
+  bool run_one() {
+    const auto own = own_queue();
+    Task task;
+    auto found = pop(own, true, task);
+    for (size_t i = 1; !found && i < queues_.size(); ++i) {
+      found = pop((own + i) % queues_.size(), false, task);
+    }
+    if (found) {
+      task();
+    }
+    return found;
+  }
+};
+
+// Default pool: one worker per hardware thread besides the caller
+inline ThreadPool& default_pool() {
+  static ThreadPool pool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+  return pool;
+}
+
+// Tasks forked on a pool and joined by wait(), which runs pool tasks until they completed
+class TaskGroup {
+  ThreadPool& pool_;
+  std::atomic<size_t> pending_{0};
+
+ public:
+  explicit TaskGroup(ThreadPool& pool) noexcept : pool_(pool) {}
+  TaskGroup(const TaskGroup&) = delete;
+  TaskGroup& operator=(const TaskGroup&) = delete;
+  ~TaskGroup() { wait(); }
+
+  template <typename Fn>
+  void run(Fn&& fn) {
+    pending_.fetch_add(1, std::memory_order_relaxed);
+    pool_.submit([this, fn = std::forward<Fn>(fn)]() mutable {
+      fn();
+      pending_.fetch_sub(1, std::memory_order_release);
+    });
+  }
+
+  void wait() {
+    while (pending_.load(std::memory_order_acquire) != 0) {
+      if (!pool_.run_one()) {
+        std::this_thread::yield();
+      }
+    }
+  }
+};
+
+namespace details_ {
+
+// Calls fn(begin, end) over [0, count) split in chunks of at least min_chunk, in parallel
+template <typename Fn>
+void ForChunks(ThreadPool& pool, size_t count, size_t min_chunk, Fn&& fn) {
+  // a few chunks per thread so stealing can even out the load
+  const auto chunks =
+      std::max<size_t>(1, std::min(count / std::max<size_t>(1, min_chunk), pool.concurrency() * 4));
+  if (chunks == 1) {
+    fn(size_t{0}, count);
+    return;
+  }
+  TaskGroup group(pool);
+  for (size_t chunk = 1; chunk < chunks; ++chunk) {
+    group.run([&fn, chunk, chunks, count]() {
+      fn(count * chunk / chunks, count * (chunk + 1) / chunks);
+    });
+  }
+  fn(size_t{0}, count / chunks);
+  group.wait();
+}
+
+template <typename Container>
+size_t ParallelSize(const Container& container) {
+  return static_cast<size_t>(std::distance(std::begin(container), std::end(container)));
+}
+
+template <typename Iterator>
+Iterator ParallelAt(Iterator first, size_t index) {
+  return first + static_cast<typename std::iterator_traits<Iterator>::difference_type>(index);
+}
+
+}  // namespace details_
+
+template <typename Container, typename Fn>
+void for_each(ThreadPool& pool, Container& container, Fn fn) {
+  const auto first = std::begin(container);
+  const auto count = details_::ParallelSize(container);
+  if (count < kSequentialCutoff) {
+    std::for_each(first, std::end(container), fn);
+    return;
+  }
+  details_::ForChunks(pool, count, kSequentialCutoff, [&](size_t begin, size_t end) {
+    std::for_each(details_::ParallelAt(first, begin), details_::ParallelAt(first, end), fn);
+  });
+}
+
+template <typename Container, typename Fn>
+void for_each(Container& container, Fn fn) {
+  for_each(default_pool(), container, std::move(fn));
+}
+
+template <typename Container, typename T>
+void fill(ThreadPool& pool, Container& container, const T& value) {
+  const auto first = std::begin(container);
+  const auto count = details_::ParallelSize(container);
+  if (count < kSequentialCutoff) {
+    std::fill(first, std::end(container), value);
+    return;
+  }
+  details_::ForChunks(pool, count, kSequentialCutoff, [&](size_t begin, size_t end) {
+    std::fill(details_::ParallelAt(first, begin), details_::ParallelAt(first, end), value);
+  });
+}
+
+template <typename Container, typename T>
+void fill(Container& container, const T& value) {
+  fill(default_pool(), container, value);
+}
+
+// requires output to hold at least as many elements as input
+template <typename Input, typename Output>
+void copy(ThreadPool& pool, const Input& input, Output& output) {
+  const auto first = std::begin(input);
+  const auto out = std::begin(output);
+  const auto count = details_::ParallelSize(input);
+  SBOVECTOR_ASSERT(details_::ParallelSize(output) >= count, "output too small");
+  if (count < kSequentialCutoff) {
+    std::copy(first, std::end(input), out);
+    return;
+  }
+  details_::ForChunks(pool, count, kSequentialCutoff, [&](size_t begin, size_t end) {
+    std::copy(details_::ParallelAt(first, begin), details_::ParallelAt(first, end),
+              details_::ParallelAt(out, begin));
+  });
+}
+
+template <typename Input, typename Output>
+void copy(const Input& input, Output& output) {
+  copy(default_pool(), input, output);
+}
+
+// output[i] = fn(input[i]), requires output to hold at least as many elements as input
+// (output may be input)
+template <typename Input, typename Output, typename Fn>
+void transform(ThreadPool& pool, const Input& input, Output& output, Fn fn) {
+  const auto first = std::begin(input);
+  const auto out = std::begin(output);
+  const auto count = details_::ParallelSize(input);
+  SBOVECTOR_ASSERT(details_::ParallelSize(output) >= count, "output too small");
+  if (count < kSequentialCutoff) {
+    std::transform(first, std::end(input), out, fn);
+    return;
+  }
+  details_::ForChunks(pool, count, kSequentialCutoff, [&](size_t begin, size_t end) {
+    std::transform(details_::ParallelAt(first, begin), details_::ParallelAt(first, end),
+                   details_::ParallelAt(out, begin), fn);
+  });
+}
+
+template <typename Input, typename Output, typename Fn>
+void transform(const Input& input, Output& output, Fn fn) {
+  transform(default_pool(), input, output, std::move(fn));
+}
+
+// op must be associative and commutative (chunks are reduced independently)
+template <typename Container, typename T, typename BinaryOp = std::plus<>>
+T reduce(ThreadPool& pool, const Container& container, T init, BinaryOp op = {}) {
+  const auto first = std::begin(container);
+  const auto count = details_::ParallelSize(container);
+  if (count < kSequentialCutoff) {
+    return std::accumulate(first, std::end(container), std::move(init), op);
+  }
+  const auto chunks = std::min(count / kSequentialCutoff, pool.concurrency() * 4);
+  std::vector<T> partials(chunks, init);
+  {
+    TaskGroup group(pool);
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+      group.run([&, chunk]() {
+        const auto begin = details_::ParallelAt(first, count * chunk / chunks);
+        const auto end = details_::ParallelAt(first, count * (chunk + 1) / chunks);
+        // every chunk starts from its first element, init is only folded in once
+        T partial = *begin;
+        partials[chunk] = std::accumulate(std::next(begin), end, std::move(partial), op);
+      });
+    }
+    group.wait();
+  }
+  return std::accumulate(partials.begin(), partials.end(), std::move(init), op);
+}
+
+template <typename Container, typename T, typename BinaryOp = std::plus<>>
+T reduce(const Container& container, T init, BinaryOp op = {}) {
+  return reduce(default_pool(), container, std::move(init), std::move(op));
+}
+
+// Sorts chunks in parallel then merges pairs of neighbouring runs, in parallel per level
+template <typename Container, typename Compare = std::less<>>
+void sort(ThreadPool& pool, Container& container, Compare comp = {}) {
+  const auto first = std::begin(container);
+  const auto count = details_::ParallelSize(container);
+  if (count < kSequentialCutoff) {
+    std::sort(first, std::end(container), comp);
+    return;
+  }
+  const auto chunks = std::min(count / kSequentialCutoff, pool.concurrency() * 4);
+  const auto bound = [&](size_t chunk) {
+    return details_::ParallelAt(first, count * std::min(chunk, chunks) / chunks);
+  };
+  {
+    TaskGroup group(pool);
+    for (size_t chunk = 0; chunk < chunks; ++chunk) {
+      group.run([&, chunk]() { std::sort(bound(chunk), bound(chunk + 1), comp); });
+    }
+  }
+  for (size_t width = 1; width < chunks; width *= 2) {
+    TaskGroup group(pool);
+    for (size_t chunk = 0; chunk + width < chunks; chunk += 2 * width) {
+      group.run([&, chunk, width]() {
+        std::inplace_merge(bound(chunk), bound(chunk + width), bound(chunk + 2 * width), comp);
+      });
+    }
+  }
+}
+
+template <typename Container, typename Compare = std::less<>>
+void sort(Container& container, Compare comp = {}) {
+  sort(default_pool(), container, std::move(comp));
+}
+
+// Calls fn(element) or fn(outer_index, element) for every element of every inner container
+// of collection (eg: std::vector<SBOVector<Edge, 8>> adjacency lists).
+// Work is split by cumulative element count (prefix sum over size()), not by inner container:
+// oversized inner containers are split over several tasks, runs of small ones are grouped.
+template <typename Collection, typename Fn>
+void for_each_element(ThreadPool& pool, Collection& collection, Fn fn) {
+  using Inner = std::remove_reference_t<decltype(*std::begin(collection))>;
+  using Element = std::remove_reference_t<decltype(*std::begin(std::declval<Inner&>()))>;
+  const auto first = std::begin(collection);
+  const auto outer_count = details_::ParallelSize(collection);
+
+  // prefix[i]: elements before inner container i, prefix[outer_count]: total
+  std::vector<size_t> prefix(outer_count + 1, 0);
+  for (size_t i = 0; i < outer_count; ++i) {
+    prefix[i + 1] = prefix[i] + details_::ParallelSize(*details_::ParallelAt(first, i));
+  }
+  const auto total = prefix.back();
+
+  // visits the global element range [begin, end)
+  const auto visit = [&](size_t begin, size_t end) {
+    auto outer = static_cast<size_t>(
+      std::upper_bound(prefix.begin(), prefix.end(), begin) - prefix.begin() - 1);
+    while (begin < end) {
+      auto& inner = *details_::ParallelAt(first, outer);
+      const auto inner_first = std::begin(inner);
+      const auto inner_end = std::min(end, prefix[outer + 1]);
+      for (auto i = begin - prefix[outer]; begin < inner_end; ++i, ++begin) {
+        if constexpr (std::is_invocable_v<Fn&, size_t, Element&>) {
+          fn(outer, *details_::ParallelAt(inner_first, i));
+        } else {
+          fn(*details_::ParallelAt(inner_first, i));
+        }
+      }
+      ++outer;
+    }
+  };
+  if (total < kSequentialCutoff) {
+    visit(0, total);
+    return;
+  }
+  details_::ForChunks(pool, total, kSequentialCutoff / 8, visit);
+}
+
+template <typename Collection, typename Fn>
+void for_each_element(Collection& collection, Fn fn) {
+  for_each_element(default_pool(), collection, std::move(fn));
+}
+
+}  // namespace parallel
+}  // namespace sbo
+
+#endif  // SBOVECTOR_PARALLEL_HPP
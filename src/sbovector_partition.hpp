@@ -0,0 +1,96 @@
+#ifndef SBOVECTOR_PARTITION_HPP
+#define SBOVECTOR_PARTITION_HPP
+
+#include "sbovector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+namespace details_ {
+
+constexpr size_t kWriteCombineBytes = 64;
+
+// One cache line of staged elements for one bucket
+template <typename DataType>
+struct alignas(kWriteCombineBytes) WriteCombineLine {
+  static constexpr size_t kCapacity = std::max<size_t>(1, kWriteCombineBytes / sizeof(DataType));
+  std::array<AlignedStorage<DataType>, kCapacity> slots_;
+};
+
+}  // namespace details_
+
+// Appends every element of [first, last) to buckets[key_fn(element)], keeping input order
+// within each bucket (a radix partition / scatter step)
+//
+// Two passes over the input: a histogram of bucket sizes then a scatter, so each bucket grows
+// once (non trivial DataTypes: once if already spilled). For trivial DataTypes the scatter
+// stages elements in one cache line per bucket and copies full lines to the buckets (software
+// write combining), so only K lines are hot rather than K bucket tails.
+//
+// buckets: random access container of SBOVectors (eg: std::vector<SBOVector<Key, 16>>)
+// key_fn(element) -> bucket index in [0, buckets.size()), called twice per element
+// requires a forward iterator
+template <typename Buckets, typename Iterator, typename KeyFn>
+void partition_into(Buckets& buckets, Iterator first, Iterator last, KeyFn&& key_fn) {
+  using Bucket = std::remove_reference_t<decltype(buckets[0])>;
+  using DataType = typename Bucket::value_type;
+  const auto bucket_count = static_cast<size_t>(std::size(buckets));
+  if (first == last || bucket_count == 0) {
+    return;
+  }
+
+  std::vector<size_t> counts(bucket_count, 0);
+  for (auto iter = first; iter != last; ++iter) {
+    const auto bucket = static_cast<size_t>(key_fn(*iter));
+    SBOVECTOR_ASSERT(bucket < bucket_count, "key_fn out of range");
+    ++counts[bucket];
+  }
+
+  if constexpr (!std::is_trivial_v<DataType>) {
+    // (no growth ahead of time for inline buckets, SBOVector only reserves external storage)
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+      buckets[bucket].reserve_if_external(buckets[bucket].size() + counts[bucket]);
+    }
+    for (; first != last; ++first) {
+      buckets[static_cast<size_t>(key_fn(*first))].push_back(*first);
+    }
+  } else {
+    using Line = details_::WriteCombineLine<DataType>;
+    // where the next full line of each bucket goes and how much of its line is staged,
+    // together so the scatter touches one state and one staged line per element
+    struct Cursor {
+      DataType* tail_;
+      size_t staged_;
+    };
+    std::vector<Cursor> cursors(bucket_count);
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+      // grown once, the whole tail is written below
+      buckets[bucket].append_uninitialized(counts[bucket], [&](DataType* tail, size_t count) {
+        cursors[bucket] = {tail, 0};
+        return count;
+      });
+    }
+    std::vector<Line> lines(bucket_count);
+    for (; first != last; ++first) {
+      const auto bucket = static_cast<size_t>(key_fn(*first));
+      auto staged = static_cast<DataType*>(static_cast<void*>(lines[bucket].slots_.data()));
+      auto& cursor = cursors[bucket];
+      staged[cursor.staged_] = *first;
+      if (++cursor.staged_ == Line::kCapacity) {
+        std::memcpy(static_cast<void*>(cursor.tail_), staged, sizeof(DataType) * Line::kCapacity);
+        cursor.tail_ += Line::kCapacity;
+        cursor.staged_ = 0;
+      }
+    }
+    for (size_t bucket = 0; bucket < bucket_count; ++bucket) {
+      std::memcpy(static_cast<void*>(cursors[bucket].tail_), lines[bucket].slots_.data(),
+                  sizeof(DataType) * cursors[bucket].staged_);
+    }
+  }
+}
+
+#endif  // SBOVECTOR_PARTITION_HPP
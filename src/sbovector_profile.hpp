@@ -0,0 +1,318 @@
+#ifndef SBOVECTOR_PROFILE_HPP
+#define SBOVECTOR_PROFILE_HPP
+
+#include "sbovector.hpp"
+#include "sbovector_stats.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <typeinfo>
+
+// Size profile of SBOVectors per call site, to pick BufferSize from a load test
+//
+// Profiling build: SBOVECTOR_ENABLE_PROFILE=true gives every SBOVector an SBOVectorProfile
+// (+16 bytes: its site and peak size()), or specialize sbovector_stats_policy for some of them.
+// A vector belongs to the site tagged by the innermost SBOVectorProfileTag of its constructing
+// thread (C++17 has no std::source_location: SBOVECTOR_PROFILE_HERE tags with file:line).
+// At destruction its final and peak size() are recorded for (tag, DataType, BufferSize).
+// The report, with a recommended BufferSize per site, is written at exit to the file named by
+// $SBOVECTOR_PROFILE_OUT (stderr if unset), see configure_sbovector_profile.
+
+// Tags the SBOVectors constructed by this thread during its lifetime (tag: a string literal)
+class SBOVectorProfileTag {
+  const char* previous_;
+
+ public:
+  explicit SBOVectorProfileTag(const char* tag) noexcept : previous_(current()) {
+    current() = tag;
+  }
+  SBOVectorProfileTag(const SBOVectorProfileTag&) = delete;
+  SBOVectorProfileTag& operator=(const SBOVectorProfileTag&) = delete;
+  ~SBOVectorProfileTag() { current() = previous_; }
+
+  // nullptr if untagged
+  static const char*& current() noexcept {
+    static thread_local const char* tag = nullptr;
+    return tag;
+  }
+};
+
+#define SBOVECTOR_PROFILE_STRINGIFY_(x) #x
+#define SBOVECTOR_PROFILE_STRINGIFY(x) SBOVECTOR_PROFILE_STRINGIFY_(x)
+#define SBOVECTOR_PROFILE_CONCAT_(a, b) a##b
+#define SBOVECTOR_PROFILE_CONCAT(a, b) SBOVECTOR_PROFILE_CONCAT_(a, b)
+
+// Tags the rest of the enclosing scope with its file:line
+#define SBOVECTOR_PROFILE_HERE                                               \
+  SBOVectorProfileTag SBOVECTOR_PROFILE_CONCAT(sbovector_profile_tag_, __LINE__)( \
+      __FILE__ ":" SBOVECTOR_PROFILE_STRINGIFY(__LINE__))
+
+namespace details_ {
+
+// sizes below are counted exactly, above in log2 buckets
+constexpr size_t kProfileExactSizes = 256;
+constexpr size_t kProfileBuckets = kProfileExactSizes + kStatsHistogramBuckets;
+
+inline size_t ProfileBucket(size_t size) noexcept {
+  if (size < kProfileExactSizes) {
+    return size;
+  }
+  return kProfileExactSizes + StatsHistogramBucket(size) - StatsHistogramBucket(kProfileExactSizes);
+}
+
+// largest size of a bucket (conservative for log2 buckets)
+inline size_t ProfileBucketSize(size_t bucket) noexcept {
+  if (bucket < kProfileExactSizes) {
+    return bucket;
+  }
+  const auto shift = bucket - kProfileExactSizes + StatsHistogramBucket(kProfileExactSizes);
+  return shift >= 64 ? SIZE_MAX : (size_t{1} << shift) - 1;
+}
+
+struct ProfileDistribution {
+  std::array<std::atomic<uint64_t>, kProfileBuckets> counts_{};
+
+  void add(size_t size) noexcept {
+    counts_[ProfileBucket(size)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  [[nodiscard]] uint64_t total() const noexcept {
+    uint64_t out = 0;
+    for (const auto& count : counts_) {
+      out += count.load(std::memory_order_relaxed);
+    }
+    return out;
+  }
+
+  // smallest size with at least fraction of the sizes <= it
+  [[nodiscard]] size_t quantile(double fraction) const noexcept {
+    const auto needed = fraction * static_cast<double>(total());
+    uint64_t seen = 0;
+    for (size_t bucket = 0; bucket < kProfileBuckets; ++bucket) {
+      seen += counts_[bucket].load(std::memory_order_relaxed);
+      if (seen > 0 && static_cast<double>(seen) >= needed) {
+        return ProfileBucketSize(bucket);
+      }
+    }
+    return 0;
+  }
+};
+
+struct ProfileAdvice {
+  size_t recommended_;
+  double current_bytes_;      // per vector, at the profiled BufferSize
+  double recommended_bytes_;  // per vector, at recommended_
+  double current_spill_rate_;
+  double recommended_spill_rate_;
+};
+
+struct ProfileSite {
+  std::string tag_;
+  std::string data_type_;
+  size_t buffer_size_;
+  size_t element_size_;
+  ProfileDistribution final_;
+  ProfileDistribution peak_;
+
+  ProfileSite(std::string tag, std::string data_type, size_t buffer_size, size_t element_size)
+      : tag_(std::move(tag)),
+        data_type_(std::move(data_type)),
+        buffer_size_(buffer_size),
+        element_size_(element_size) {}
+
+  void record(size_t final_size, size_t peak_size) noexcept {
+    final_.add(final_size);
+    peak_.add(peak_size);
+  }
+
+  // Average bytes per vector at buffer_size: the inline buffer, plus for vectors whose peak
+  // spilled their heap buffer (exact size) and spill_cost (allocation, indirection)
+  [[nodiscard]] std::pair<double, double> cost(size_t buffer_size, double spill_cost) const {
+    double bytes = 0;
+    double spilled = 0;
+    double total = 0;
+    for (size_t bucket = 0; bucket < kProfileBuckets; ++bucket) {
+      const auto count = static_cast<double>(peak_.counts_[bucket].load(std::memory_order_relaxed));
+      const auto size = ProfileBucketSize(bucket);
+      total += count;
+      bytes += count * static_cast<double>(buffer_size * element_size_);
+      if (size > buffer_size) {
+        spilled += count;
+        bytes += count * (spill_cost + static_cast<double>(size) * static_cast<double>(element_size_));
+      }
+    }
+    return total > 0 ? std::make_pair(bytes / total, spilled / total) : std::make_pair(0.0, 0.0);
+  }
+
+  // BufferSize in [1, peak percentile] with the lowest cost()
+  [[nodiscard]] ProfileAdvice advise(double percentile, double spill_cost) const {
+    const auto limit = std::max<size_t>(1, peak_.quantile(percentile));
+    ProfileAdvice out{buffer_size_, 0, 0, 0, 0};
+    std::tie(out.current_bytes_, out.current_spill_rate_) = cost(buffer_size_, spill_cost);
+    auto best = cost(1, spill_cost);
+    out.recommended_ = 1;
+    // candidates: the recorded sizes (the cost is linear in between)
+    for (size_t bucket = 2; bucket < kProfileBuckets && ProfileBucketSize(bucket) <= limit; ++bucket) {
+      if (peak_.counts_[bucket].load(std::memory_order_relaxed) == 0) {
+        continue;
+      }
+      const auto candidate = cost(ProfileBucketSize(bucket), spill_cost);
+      if (candidate.first < best.first) {
+        best = candidate;
+        out.recommended_ = ProfileBucketSize(bucket);
+      }
+    }
+    std::tie(out.recommended_bytes_, out.recommended_spill_rate_) = best;
+    return out;
+  }
+
+  void write(std::ostream& out, double percentile, double spill_cost) const {
+    const auto quantiles = [&](const ProfileDistribution& distribution) {
+      out << " p50: " << distribution.quantile(0.5) << " p90: " << distribution.quantile(0.9)
+          << " p99: " << distribution.quantile(0.99) << " max: " << distribution.quantile(1.0);
+    };
+    const auto advice = advise(percentile, spill_cost);
+    out << tag_ << " SBOVector<" << data_type_ << ", " << buffer_size_ << ">"
+        << " vectors: " << peak_.total() << "\n  final size:";
+    quantiles(final_);
+    out << "\n  peak size:";
+    quantiles(peak_);
+    out << "\n  BufferSize " << buffer_size_ << ": spilled " << advice.current_spill_rate_ * 100
+        << "% " << advice.current_bytes_ << " bytes/vector"
+        << "\n  recommended BufferSize: " << advice.recommended_ << " (spilled "
+        << advice.recommended_spill_rate_ * 100 << "% " << advice.recommended_bytes_
+        << " bytes/vector)\n";
+  }
+};
+
+struct ProfileConfig {
+  std::string path_;
+  double percentile_;
+  double spill_cost_;
+};
+
+constexpr double kProfileDefaultPercentile = 0.99;
+// bytes charged per spill: allocator overhead and the cost of an extra cache miss
+constexpr double kProfileDefaultSpillCost = 64;
+
+inline ProfileConfig& ProfileReportConfig() {
+  static auto config = []() {
+    const auto path = std::getenv("SBOVECTOR_PROFILE_OUT");
+    return new ProfileConfig{path ? path : "", kProfileDefaultPercentile, kProfileDefaultSpillCost};
+  }();
+  return *config;
+}
+
+class ProfileRegistry {
+  std::mutex mutex_;
+  std::map<std::tuple<std::string, std::string, size_t>, ProfileSite*> sites_;
+
+ public:
+  // never destroyed (nor are the sites): SBOVectors may die during static destruction
+  static ProfileRegistry& instance() {
+    static auto registry = new ProfileRegistry();
+    return *registry;
+  }
+
+  ProfileSite* site(const char* tag, const std::string& data_type, size_t buffer_size,
+                    size_t element_size);
+
+  void write(std::ostream& out, double percentile, double spill_cost) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    out << "SBOVector BufferSize profile (percentile: " << percentile
+        << ", spill cost: " << spill_cost << " bytes)\n";
+    for (const auto& site : sites_) {
+      site.second->write(out, percentile, spill_cost);
+    }
+  }
+};
+
+}  // namespace details_
+
+// Writes the profile of every site so far, see ProfileSite::advise for the recommendation
+inline void write_sbovector_profile(
+      std::ostream& out,
+      double percentile = details_::kProfileDefaultPercentile,
+      double spill_cost = details_::kProfileDefaultSpillCost
+    ) {
+  details_::ProfileRegistry::instance().write(out, percentile, spill_cost);
+}
+
+// Where/how the exit report is written (path: stderr if empty)
+inline void configure_sbovector_profile(
+      std::string path,
+      double percentile = details_::kProfileDefaultPercentile,
+      double spill_cost = details_::kProfileDefaultSpillCost
+    ) {
+  details_::ProfileReportConfig() = {std::move(path), percentile, spill_cost};
+}
+
+inline details_::ProfileSite* details_::ProfileRegistry::site(
+      const char* tag,
+      const std::string& data_type,
+      size_t buffer_size,
+      size_t element_size
+    ) {
+  static const bool registered = []() {
+    ProfileReportConfig();
+    std::atexit([]() {
+      const auto& config = ProfileReportConfig();
+      if (config.path_.empty()) {
+        write_sbovector_profile(std::cerr, config.percentile_, config.spill_cost_);
+        return;
+      }
+      std::ofstream out(config.path_);
+      write_sbovector_profile(out, config.percentile_, config.spill_cost_);
+    });
+    return true;
+  }();
+  static_cast<void>(registered);
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto& site = sites_[{tag ? tag : "<untagged>", data_type, buffer_size}];
+  if (!site) {
+    site = new ProfileSite(tag ? tag : "<untagged>", data_type, buffer_size, element_size);
+  }
+  return site;
+}
+
+// Profiling stats policy: per vector site and peak size(), see sbovector_stats_policy
+template <typename DataType, size_t BufferSize, typename Allocator, bool Compact>
+class SBOVectorProfile {
+  details_::ProfileSite* site_;
+  size_t peak_;
+
+  static details_::ProfileSite* current_site() {
+    static thread_local const char* cached_tag = nullptr;
+    static thread_local details_::ProfileSite* cached_site = nullptr;
+    const auto tag = SBOVectorProfileTag::current();
+    if (!cached_site || cached_tag != tag) {
+      static const auto data_type = details_::DemangledName(typeid(DataType).name());
+      cached_site = details_::ProfileRegistry::instance().site(
+          tag, data_type, BufferSize, sizeof(DataType));
+      cached_tag = tag;
+    }
+    return cached_site;
+  }
+
+ public:
+  SBOVectorProfile() : site_(current_site()), peak_(0) {}
+
+  void on_grow(size_t new_size) noexcept { peak_ = std::max(peak_, new_size); }
+  static constexpr void on_spill(size_t, size_t, size_t) noexcept {}
+  static constexpr void on_reallocate(size_t, size_t, size_t) noexcept {}
+  static constexpr void on_internalize(size_t) noexcept {}
+  void on_destroy(size_t size) noexcept { site_->record(size, std::max(peak_, size)); }
+};
+
+#endif  // SBOVECTOR_PROFILE_HPP
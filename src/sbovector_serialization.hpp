@@ -0,0 +1,233 @@
+#ifndef SBOVECTOR_SERIALIZATION_HPP
+#define SBOVECTOR_SERIALIZATION_HPP
+
+#include "sbovector.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
+
+// Binary serialization of SBOVectors of trivially copyable data
+//
+// Layout, one record per vector, records are back to back:
+//   uint64_t count
+//   padding up to alignof(DataType) (only if alignof(DataType) > 8)
+//   DataType[count]
+//   padding up to the record alignment: max(8, alignof(DataType))
+// Every record starts record aligned, so a buffer that starts aligned
+// (eg: an mmapped file) can be read in place through SBOVectorView.
+// Native endianness and layout, not intended as an interchange format.
+
+namespace details_ {
+
+template <typename DataType>
+constexpr size_t kSerializedAlignment =
+    std::max(alignof(std::uint64_t), alignof(DataType));
+
+template <typename DataType>
+constexpr size_t kSerializedHeaderSize = kSerializedAlignment<DataType>;
+
+constexpr size_t AlignUp(size_t value, size_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// count is bounds checked against the buffer before narrowing
+template <typename Count>
+constexpr size_t SerializedCount(Count count) {
+  if constexpr (sizeof(size_t) < sizeof(Count)) {
+    return static_cast<size_t>(count);
+  } else {
+    return count;
+  }
+}
+
+template <typename DataType>
+constexpr void AssertSerializable() {
+  static_assert(std::is_trivially_copyable_v<DataType>,
+                "Only trivially copyable DataType can be serialized");
+}
+
+}  // namespace details_
+
+// Read only view of count elements (eg: a serialized record in a mapped file)
+template <typename DataType>
+class SBOVectorView {
+  const DataType* data_;
+  size_t size_;
+
+ public:
+  using value_type = DataType;
+  using size_type = size_t;
+  using const_pointer = const DataType*;
+  using const_iterator = const DataType*;
+  using const_reference = const DataType&;
+
+  SBOVectorView() noexcept : data_(nullptr), size_(0) {}
+  SBOVectorView(const DataType* data, size_t size) noexcept : data_(data), size_(size) {}
+
+  template <size_t BufferSize, typename Allocator, bool Compact>
+  SBOVectorView(const SBOVector<DataType, BufferSize, Allocator, Compact>& vector) noexcept
+      : data_(vector.data()), size_(vector.size()) {}
+
+  [[nodiscard]] const_reference at(size_t index) const noexcept { return data_[index]; }
+  [[nodiscard]] const_reference operator[](size_t index) const noexcept {
+    return data_[index];
+  }
+  [[nodiscard]] const_reference front() const noexcept { return data_[0]; }
+  [[nodiscard]] const_reference back() const noexcept { return data_[size_ - 1]; }
+
+  [[nodiscard]] const_pointer data() const noexcept { return data_; }
+  [[nodiscard]] const_iterator begin() const noexcept { return data_; }
+  [[nodiscard]] const_iterator cbegin() const noexcept { return data_; }
+  [[nodiscard]] const_iterator end() const noexcept { return data_ + size_; }
+  [[nodiscard]] const_iterator cend() const noexcept { return end(); }
+
+  [[nodiscard]] bool empty() const noexcept { return 0 == size_; }
+  [[nodiscard]] size_t size() const noexcept { return size_; }
+};
+
+// Bytes taken by the record of a count element vector
+template <typename DataType>
+constexpr size_t serialized_size(size_t count) noexcept {
+  details_::AssertSerializable<DataType>();
+  return details_::AlignUp(
+    details_::kSerializedHeaderSize<DataType> + count * sizeof(DataType),
+    details_::kSerializedAlignment<DataType>
+  );
+}
+
+template <typename DataType, size_t BufferSize, typename Allocator, bool Compact>
+size_t serialized_size(const SBOVector<DataType, BufferSize, Allocator, Compact>& vector) noexcept {
+  return serialized_size<DataType>(vector.size());
+}
+
+// Writes the record of vector to out, out must be record aligned and hold
+// serialized_size(vector) bytes, returns the end of the record
+template <typename DataType, size_t BufferSize, typename Allocator, bool Compact>
+char* serialize_to(
+      const SBOVector<DataType, BufferSize, Allocator, Compact>& vector,
+      char* out
+    ) noexcept {
+  const auto count = static_cast<std::uint64_t>(vector.size());
+  const auto data_bytes = vector.size() * sizeof(DataType);
+  const auto record_bytes = serialized_size(vector);
+  std::memcpy(out, &count, sizeof(count));
+  std::memset(out + sizeof(count), 0, details_::kSerializedHeaderSize<DataType> - sizeof(count));
+  out += details_::kSerializedHeaderSize<DataType>;
+  std::memcpy(out, vector.data(), data_bytes);
+  out += data_bytes;
+  const auto padding = record_bytes - details_::kSerializedHeaderSize<DataType> - data_bytes;
+  std::memset(out, 0, padding);
+  return out + padding;
+}
+
+// Appends the record of vector to out (which is assumed to be record aligned)
+template <typename DataType, size_t BufferSize, typename Allocator, bool Compact>
+bool write_serialized(
+      std::ostream& out,
+      const SBOVector<DataType, BufferSize, Allocator, Compact>& vector
+    ) {
+  static constexpr char kZeroes[details_::kSerializedAlignment<DataType>] = {};
+  const auto count = static_cast<std::uint64_t>(vector.size());
+  const auto data_bytes = vector.size() * sizeof(DataType);
+  const auto padding =
+      serialized_size(vector) - details_::kSerializedHeaderSize<DataType> - data_bytes;
+  out.write(static_cast<const char*>(static_cast<const void*>(&count)), sizeof(count));
+  out.write(
+    kZeroes,
+    static_cast<std::streamsize>(details_::kSerializedHeaderSize<DataType> - sizeof(count))
+  );
+  out.write(
+    static_cast<const char*>(static_cast<const void*>(vector.data())),
+    static_cast<std::streamsize>(data_bytes)
+  );
+  out.write(kZeroes, static_cast<std::streamsize>(padding));
+  return static_cast<bool>(out);
+}
+
+// Sequential reader of records from a record aligned buffer
+// the buffer must outlive every SBOVectorView handed out
+template <typename DataType>
+class SerializedSBOVectorReader {
+  const char* pos_;
+  const char* end_;
+  bool failed_;
+
+ public:
+  SerializedSBOVectorReader(const void* data, size_t bytes) noexcept
+      : pos_(static_cast<const char*>(data)),
+        end_(static_cast<const char*>(data) + bytes),
+        failed_(reinterpret_cast<std::uintptr_t>(data) %
+                    details_::kSerializedAlignment<DataType> != 0) {
+    details_::AssertSerializable<DataType>();
+  }
+
+  // true if every record has been read
+  [[nodiscard]] bool done() const noexcept { return failed_ || pos_ == end_; }
+
+  // true if a malformed/truncated record or misaligned buffer was encountered
+  [[nodiscard]] bool failed() const noexcept { return failed_; }
+
+  // Zero copy: out points straight into the buffer
+  bool next(SBOVectorView<DataType>& out) noexcept {
+    constexpr auto kHeaderSize = details_::kSerializedHeaderSize<DataType>;
+    if (done()) {
+      return false;
+    }
+    const auto remaining = static_cast<size_t>(end_ - pos_);
+    std::uint64_t count;
+    if (remaining < kHeaderSize) {
+      failed_ = true;
+      return false;
+    }
+    std::memcpy(&count, pos_, sizeof(count));
+    if (count > (remaining - kHeaderSize) / sizeof(DataType)) {
+      failed_ = true;
+      return false;
+    }
+    const auto size = details_::SerializedCount(count);
+    const auto record_bytes = serialized_size<DataType>(size);
+    if (record_bytes > remaining) {
+      failed_ = true;
+      return false;
+    }
+    out = SBOVectorView<DataType>(
+      static_cast<const DataType*>(static_cast<const void*>(pos_ + kHeaderSize)),
+      size
+    );
+    pos_ += record_bytes;
+    return true;
+  }
+
+  // Materializing: out is replaced by a copy of the record, storage (inline or external) is
+  // picked once for the whole record: an external buffer large enough is kept for the next
+  // the record is copied with memcpy, not element by element
+  template <size_t BufferSize, typename Allocator, bool Compact>
+  bool next(SBOVector<DataType, BufferSize, Allocator, Compact>& out) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    SBOVectorView<DataType> view;
+    if (!next(view)) {
+      return false;
+    }
+    const auto size = view.size();
+    if (size <= BufferSize || size > out.capacity()) {
+      // (empty: growth allocates exactly once and copies none of the old elements)
+      out.clear();
+    } else if (size < out.size()) {
+      out.erase(out.begin() + size, out.end());
+    }
+    const auto kept = out.size();
+    if (kept) {
+      std::memcpy(out.data(), view.data(), kept * sizeof(DataType));
+    }
+    out.append_uninitialized(size - kept, [&](DataType* tail, size_t count) {
+      if (count) {
+        std::memcpy(tail, view.data() + kept, count * sizeof(DataType));
+      }
+      return count;
+    });
+    return true;
+  }
+};
+
+#endif  // SBOVECTOR_SERIALIZATION_HPP
@@ -0,0 +1,251 @@
+#ifndef SBOVECTOR_STATS_HPP
+#define SBOVECTOR_STATS_HPP
+
+#include "sbovector.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+// Per instantiation counters of SBOVector storage transitions, to check BufferSize choices
+//
+// Enabled for every SBOVector with SBOVECTOR_ENABLE_STATS=true, or for chosen instantiations by
+// specializing sbovector_stats_policy (before their first use):
+//   template <> struct sbovector_stats_policy<Edge, 8, std::allocator<Edge>, false> {
+//     using type = SBOVectorStats<Edge, 8, std::allocator<Edge>, false>;
+//   };
+// Counters are relaxed atomics (any thread), dumped by dump_sbovector_stats() on demand or
+// by dump_sbovector_stats_at_exit().
+
+enum class StatsFormat { kText, kJson };
+
+namespace details_ {
+
+// log2 size buckets: [0], [1], [2, 3], [4, 7], ...
+constexpr size_t kStatsHistogramBuckets = 65;
+
+inline size_t StatsHistogramBucket(size_t size) noexcept {
+  size_t bucket = 0;
+  while (size) {
+    size >>= 1;
+    ++bucket;
+  }
+  return bucket;
+}
+
+inline std::string DemangledName(const char* name) {
+#if __has_include(<cxxabi.h>)
+  int status = 0;
+  std::unique_ptr<char, void (*)(void*)> demangled(
+      abi::__cxa_demangle(name, nullptr, nullptr, &status), std::free);
+  if (status == 0 && demangled) {
+    return demangled.get();
+  }
+#endif
+  return name;
+}
+
+struct StatsCounters {
+  std::string data_type_;
+  size_t buffer_size_;
+  size_t element_size_;
+
+  std::atomic<uint64_t> destroyed_{0};
+  std::atomic<uint64_t> spills_{0};
+  std::atomic<uint64_t> internalizations_{0};
+  std::atomic<uint64_t> reallocations_{0};
+  std::atomic<uint64_t> bytes_moved_{0};
+  std::atomic<uint64_t> peak_size_{0};
+  // of sizes at destruction
+  std::array<std::atomic<uint64_t>, kStatsHistogramBuckets> histogram_{};
+
+  StatsCounters(std::string data_type, size_t buffer_size, size_t element_size)
+      : data_type_(std::move(data_type)), buffer_size_(buffer_size), element_size_(element_size) {}
+
+  void add_moved(size_t moved) noexcept {
+    bytes_moved_.fetch_add(uint64_t{moved} * element_size_, std::memory_order_relaxed);
+  }
+
+  void update_peak(size_t size) noexcept {
+    auto peak = peak_size_.load(std::memory_order_relaxed);
+    while (peak < size &&
+           !peak_size_.compare_exchange_weak(peak, size, std::memory_order_relaxed)) {
+    }
+  }
+
+  void reset() noexcept {
+    for (auto counter : {&destroyed_, &spills_, &internalizations_, &reallocations_,
+                         &bytes_moved_, &peak_size_}) {
+      counter->store(0, std::memory_order_relaxed);
+    }
+    for (auto& bucket : histogram_) {
+      bucket.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  void write(std::ostream& out, StatsFormat format) const {
+    const auto load = [](const std::atomic<uint64_t>& counter) {
+      return counter.load(std::memory_order_relaxed);
+    };
+    if (format == StatsFormat::kJson) {
+      out << "{\"data_type\": \"" << data_type_ << "\", \"buffer_size\": " << buffer_size_
+          << ", \"element_size\": " << element_size_ << ", \"destroyed\": " << load(destroyed_)
+          << ", \"spills\": " << load(spills_)
+          << ", \"internalizations\": " << load(internalizations_)
+          << ", \"reallocations\": " << load(reallocations_)
+          << ", \"bytes_moved\": " << load(bytes_moved_)
+          << ", \"peak_size\": " << load(peak_size_) << ", \"log2_size_histogram\": [";
+      for (size_t i = 0; i < histogram_.size(); ++i) {
+        out << (i ? ", " : "") << load(histogram_[i]);
+      }
+      out << "]}";
+      return;
+    }
+    out << "SBOVector<" << data_type_ << ", " << buffer_size_ << ">"
+        << " destroyed: " << load(destroyed_) << " spills: " << load(spills_)
+        << " internalizations: " << load(internalizations_)
+        << " reallocations: " << load(reallocations_)
+        << " bytes_moved: " << load(bytes_moved_) << " peak_size: " << load(peak_size_)
+        << "\n  sizes:";
+    for (size_t i = 0; i < histogram_.size(); ++i) {
+      if (auto count = load(histogram_[i])) {
+        const auto low = i ? size_t{1} << (i - 1) : 0;
+        out << " [" << low << ".." << (i ? low * 2 - 1 : 0) << "]: " << count;
+      }
+    }
+  }
+};
+
+class StatsRegistry {
+  std::mutex mutex_;
+  std::vector<StatsCounters*> counters_;
+
+ public:
+  // never destroyed (nor are the counters): SBOVectors may die during static destruction
+  static StatsRegistry& instance() {
+    static auto registry = new StatsRegistry();
+    return *registry;
+  }
+
+  void add(StatsCounters* counters) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    counters_.push_back(counters);
+  }
+
+  void write(std::ostream& out, StatsFormat format) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (format == StatsFormat::kJson) {
+      out << "[";
+      for (size_t i = 0; i < counters_.size(); ++i) {
+        out << (i ? ",\n " : "");
+        counters_[i]->write(out, format);
+      }
+      out << "]\n";
+      return;
+    }
+    for (auto counters : counters_) {
+      counters->write(out, format);
+      out << "\n";
+    }
+  }
+
+  void reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto counters : counters_) {
+      counters->reset();
+    }
+  }
+};
+
+struct StatsAtExit {
+  std::string path_;
+  StatsFormat format_;
+};
+
+inline StatsAtExit& StatsAtExitTarget() {
+  static auto target = new StatsAtExit{{}, StatsFormat::kText};
+  return *target;
+}
+
+}  // namespace details_
+
+// Counting stats policy, see sbovector_stats_policy
+template <typename DataType, size_t BufferSize, typename Allocator, bool Compact>
+struct SBOVectorStats {
+  static details_::StatsCounters& counters() {
+    static details_::StatsCounters* const counters = []() {
+      auto out = new details_::StatsCounters(
+          details_::DemangledName(typeid(DataType).name()), BufferSize, sizeof(DataType));
+      details_::StatsRegistry::instance().add(out);
+      return out;
+    }();
+    return *counters;
+  }
+
+  static void on_grow(size_t new_size) noexcept { counters().update_peak(new_size); }
+
+  static void on_spill(size_t /*new_size*/, size_t moved, size_t /*new_capacity*/) noexcept {
+    auto& stats = counters();
+    stats.spills_.fetch_add(1, std::memory_order_relaxed);
+    stats.add_moved(moved);
+  }
+
+  static void on_reallocate(size_t /*new_size*/, size_t moved, size_t /*new_capacity*/) noexcept {
+    auto& stats = counters();
+    stats.reallocations_.fetch_add(1, std::memory_order_relaxed);
+    stats.add_moved(moved);
+  }
+
+  static void on_internalize(size_t moved) noexcept {
+    auto& stats = counters();
+    stats.internalizations_.fetch_add(1, std::memory_order_relaxed);
+    stats.add_moved(moved);
+  }
+
+  static void on_destroy(size_t size) noexcept {
+    auto& stats = counters();
+    stats.destroyed_.fetch_add(1, std::memory_order_relaxed);
+    stats.histogram_[details_::StatsHistogramBucket(size)].fetch_add(1, std::memory_order_relaxed);
+    stats.update_peak(size);
+  }
+};
+
+// Every instrumented instantiation used so far
+inline void dump_sbovector_stats(std::ostream& out, StatsFormat format = StatsFormat::kText) {
+  details_::StatsRegistry::instance().write(out, format);
+}
+
+inline void reset_sbovector_stats() { details_::StatsRegistry::instance().reset(); }
+
+// Dumps to path (stderr if empty) at normal program termination, the last call wins
+inline void dump_sbovector_stats_at_exit(std::string path = {},
+                                         StatsFormat format = StatsFormat::kText) {
+  static const bool registered = []() {
+    std::atexit([]() {
+      const auto& target = details_::StatsAtExitTarget();
+      if (target.path_.empty()) {
+        dump_sbovector_stats(std::cerr, target.format_);
+        return;
+      }
+      std::ofstream out(target.path_);
+      dump_sbovector_stats(out, target.format_);
+    });
+    return true;
+  }();
+  static_cast<void>(registered);
+  details_::StatsAtExitTarget() = {std::move(path), format};
+}
+
+#endif  // SBOVECTOR_STATS_HPP
@@ -0,0 +1,149 @@
+#include "benchmark_common.hpp"
+
+#include "sbovector_serialization.hpp"
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <string>
+
+// Loading a file of many small serialized lists:
+// element by element rebuild (the naive loader) vs materializing reads vs zero copy views.
+// The file is written once per size (state.range(0) in MB) and mapped read only.
+// A 1 GB file in /tmp: only registered with SBOVECTOR_BENCHMARK_LARGE=1
+
+namespace {
+
+constexpr size_t kListBufferSize = 8;
+using ListType = SBOVector<uint32_t, kListBufferSize>;
+
+class MappedListFile {
+  std::string path_;
+  void* data_ = MAP_FAILED;
+  size_t size_ = 0;
+
+ public:
+  explicit MappedListFile(size_t megabytes) {
+    path_ = "/tmp/sbovector_serialization_" + std::to_string(getpid()) + "_" +
+            std::to_string(megabytes) + ".bin";
+    {
+      std::ofstream out(path_, std::ios::binary);
+      std::mt19937 rng(42);
+      // mostly inline sized lists, with a tail that spills
+      std::geometric_distribution<size_t> list_size(0.2);
+      ListType list;
+      const auto target = megabytes << 20;
+      while (size_ < target) {
+        list.clear();
+        const auto count = list_size(rng);
+        for (auto i = 0u; i < count; ++i) {
+          list.push_back(static_cast<uint32_t>(rng()));
+        }
+        write_serialized(out, list);
+        size_ += serialized_size(list);
+      }
+    }
+    const auto fd = open(path_.c_str(), O_RDONLY);
+    if (fd >= 0) {
+      data_ = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE | MAP_POPULATE, fd, 0);
+      close(fd);
+    }
+  }
+
+  ~MappedListFile() {
+    if (data_ != MAP_FAILED) {
+      munmap(data_, size_);
+    }
+    unlink(path_.c_str());
+  }
+
+  bool valid() const { return data_ != MAP_FAILED; }
+  const void* data() const { return data_; }
+  size_t size() const { return size_; }
+};
+
+const MappedListFile& GetListFile(size_t megabytes) {
+  // one file per process (the benchmarks only use one size)
+  static MappedListFile file(megabytes);
+  return file;
+}
+
+template <typename LoadAll>
+void RunLoad(benchmark::State& state, LoadAll&& load_all) {
+  const auto& file = GetListFile(static_cast<size_t>(state.range(0)));
+  if (!file.valid()) {
+    state.SkipWithError("unable to create/map the list file");
+    return;
+  }
+  size_t lists = 0;
+  for (auto _ : state) {
+    SerializedSBOVectorReader<uint32_t> reader(file.data(), file.size());
+    uint64_t checksum = 0;
+    lists = load_all(reader, checksum);
+    benchmark::DoNotOptimize(checksum);
+  }
+  state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(file.size()));
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(lists));
+}
+
+}  // namespace
+
+static void BM_LoadListsElementwise(benchmark::State& state) {
+  RunLoad(state, [](SerializedSBOVectorReader<uint32_t>& reader, uint64_t& checksum) {
+    size_t lists = 0;
+    SBOVectorView<uint32_t> view;
+    while (reader.next(view)) {
+      ListType list;
+      for (auto value : view) {
+        list.push_back(value);
+      }
+      checksum += list.size() ? list.back() : 0;
+      ++lists;
+    }
+    return lists;
+  });
+}
+
+static void BM_LoadListsMaterialized(benchmark::State& state) {
+  RunLoad(state, [](SerializedSBOVectorReader<uint32_t>& reader, uint64_t& checksum) {
+    size_t lists = 0;
+    ListType list;
+    while (reader.next(list)) {
+      checksum += list.size() ? list.back() : 0;
+      ++lists;
+    }
+    return lists;
+  });
+}
+
+static void BM_LoadListsView(benchmark::State& state) {
+  RunLoad(state, [](SerializedSBOVectorReader<uint32_t>& reader, uint64_t& checksum) {
+    size_t lists = 0;
+    SBOVectorView<uint32_t> view;
+    while (reader.next(view)) {
+      checksum += view.size() ? view.back() : 0;
+      ++lists;
+    }
+    return lists;
+  });
+}
+
+#define LOAD_LISTS_BENCHMARK(NAME) \
+  benchmark::RegisterBenchmark(#NAME, NAME)->Arg(1024)->Unit(benchmark::kMillisecond)
+
+static const bool kLoadListsRegistered = LargeBenchmarksEnabled() && []() {
+  LOAD_LISTS_BENCHMARK(BM_LoadListsElementwise);
+  LOAD_LISTS_BENCHMARK(BM_LoadListsMaterialized);
+  LOAD_LISTS_BENCHMARK(BM_LoadListsView);
+  return true;
+}();
+
+#endif  // defined(__linux__)
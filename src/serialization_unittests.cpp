@@ -0,0 +1,184 @@
+#include "unittest_common.hpp"
+
+#include "sbovector_serialization.hpp"
+
+#include <sstream>
+
+// Unittests for binary serialization, SBOVectorView and SerializedSBOVectorReader
+
+namespace {
+
+struct alignas(16) Wide {
+  int32_t value_;
+  bool operator==(const Wide& that) const { return value_ == that.value_; }
+};
+
+// trivially copyable, not trivial (default member initializer)
+struct Initialized {
+  int32_t value_ = -1;
+  bool operator==(const Initialized& that) const { return value_ == that.value_; }
+};
+
+template <typename DataType, size_t BufferSize>
+std::vector<SBOVector<DataType, BufferSize>> MakeLists() {
+  std::vector<SBOVector<DataType, BufferSize>> out;
+  for (auto count : {size_t{0}, SMALL_SIZE, SBO_SIZE, SBO_SIZE + 1, LARGE_SIZE, size_t{1}}) {
+    out.emplace_back();
+    for (auto i = 0u; i < count; ++i) {
+      out.back().push_back(DataType{static_cast<int32_t>(i * 7 + count)});
+    }
+  }
+  return out;
+}
+
+template <typename DataType, size_t BufferSize>
+std::string SerializeLists(const std::vector<SBOVector<DataType, BufferSize>>& lists) {
+  std::ostringstream out;
+  for (const auto& list : lists) {
+    EXPECT_TRUE(write_serialized(out, list));
+  }
+  return out.str();
+}
+
+// std::string storage is not guaranteed to be aligned for records of alignof > 16
+template <typename DataType>
+std::vector<std::max_align_t> AlignedCopy(const std::string& bytes) {
+  static_assert(alignof(std::max_align_t) >= alignof(DataType));
+  std::vector<std::max_align_t> out(bytes.size() / sizeof(std::max_align_t) + 1);
+  std::memcpy(out.data(), bytes.data(), bytes.size());
+  return out;
+}
+
+}  // namespace
+
+TEST(ValueVerifiedSBOVector, MustComputeSerializedSize) {
+  EXPECT_EQ(serialized_size<uint32_t>(0), 8);
+  EXPECT_EQ(serialized_size<uint32_t>(1), 16);
+  EXPECT_EQ(serialized_size<uint32_t>(2), 16);
+  EXPECT_EQ(serialized_size<uint32_t>(3), 24);
+  EXPECT_EQ(serialized_size<Wide>(0), 16);
+  EXPECT_EQ(serialized_size<Wide>(3), 64);
+}
+
+TEST(ValueVerifiedSBOVector, MustRoundTripThroughView) {
+  const auto lists = MakeLists<int32_t, SBO_SIZE>();
+  const auto bytes = SerializeLists(lists);
+  const auto aligned = AlignedCopy<int32_t>(bytes);
+  SerializedSBOVectorReader<int32_t> reader(aligned.data(), bytes.size());
+  const auto* base = reinterpret_cast<const char*>(aligned.data());
+  SBOVectorView<int32_t> view;
+  for (const auto& list : lists) {
+    ASSERT_TRUE(reader.next(view));
+    EXPECT_RANGE_EQ(view, list);
+    // zero copy: the view points into the buffer
+    if (!view.empty()) {
+      const auto* p = reinterpret_cast<const char*>(view.data());
+      EXPECT_GE(p, base);
+      EXPECT_LT(p, base + bytes.size());
+    }
+  }
+  EXPECT_FALSE(reader.next(view));
+  EXPECT_TRUE(reader.done());
+  EXPECT_FALSE(reader.failed());
+}
+
+TEST(ValueVerifiedSBOVector, MustRoundTripMaterialized) {
+  const auto lists = MakeLists<int32_t, SBO_SIZE>();
+  const auto bytes = SerializeLists(lists);
+  const auto aligned = AlignedCopy<int32_t>(bytes);
+  SerializedSBOVectorReader<int32_t> reader(aligned.data(), bytes.size());
+  SBOVector<int32_t, SBO_SIZE> out(LARGE_SIZE, -1);
+  for (const auto& list : lists) {
+    ASSERT_TRUE(reader.next(out));
+    EXPECT_RANGE_EQ(out, list);
+    EXPECT_EQ(out.capacity(), std::max(list.size(), SBO_SIZE));
+  }
+  EXPECT_TRUE(reader.done());
+  EXPECT_FALSE(reader.failed());
+}
+
+TEST(ValueVerifiedSBOVector, MustRoundTripMaterializedTriviallyCopyable) {
+  static_assert(std::is_trivially_copyable_v<Initialized> && !std::is_trivial_v<Initialized>);
+  const auto lists = MakeLists<Initialized, SBO_SIZE>();
+  const auto bytes = SerializeLists(lists);
+  const auto aligned = AlignedCopy<Initialized>(bytes);
+  SerializedSBOVectorReader<Initialized> reader(aligned.data(), bytes.size());
+  SBOVector<Initialized, SBO_SIZE> out;
+  for (const auto& list : lists) {
+    ASSERT_TRUE(reader.next(out));
+    EXPECT_RANGE_EQ(out, list);
+  }
+  EXPECT_TRUE(reader.done());
+  EXPECT_FALSE(reader.failed());
+}
+
+TEST(ValueVerifiedSBOVector, MustKeepExternalBufferAcrossRecords) {
+  using AllocatorType = CountingAllocator<int32_t>;
+  // both spilled, the second fits in the buffer of the first
+  std::vector<SBOVector<int32_t, SBO_SIZE>> lists;
+  lists.emplace_back(LARGE_SIZE, 7);
+  lists.emplace_back(SBO_SIZE + 1, 11);
+  const auto bytes = SerializeLists(lists);
+  const auto aligned = AlignedCopy<int32_t>(bytes);
+  SerializedSBOVectorReader<int32_t> reader(aligned.data(), bytes.size());
+  AllocatorType::Totals totals;
+  SBOVector<int32_t, SBO_SIZE, AllocatorType> out{AllocatorType(&totals)};
+  for (const auto& list : lists) {
+    ASSERT_TRUE(reader.next(out));
+    EXPECT_RANGE_EQ(out, list);
+  }
+  EXPECT_EQ(totals.allocs_, 1);
+  EXPECT_EQ(totals.frees_, 0);
+}
+
+TEST(ValueVerifiedSBOVector, MustSerializeToBuffer) {
+  const auto lists = MakeLists<Wide, SMALL_SIZE>();
+  const auto bytes = SerializeLists(lists);
+  size_t total = 0;
+  for (const auto& list : lists) {
+    total += serialized_size(list);
+  }
+  ASSERT_EQ(total, bytes.size());
+  std::vector<std::max_align_t> buffer(total / sizeof(std::max_align_t) + 1);
+  auto out = reinterpret_cast<char*>(buffer.data());
+  for (const auto& list : lists) {
+    out = serialize_to(list, out);
+  }
+  EXPECT_EQ(std::memcmp(buffer.data(), bytes.data(), total), 0);
+
+  SerializedSBOVectorReader<Wide> reader(buffer.data(), total);
+  SBOVectorView<Wide> view;
+  for (const auto& list : lists) {
+    ASSERT_TRUE(reader.next(view));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(view.data()) % alignof(Wide), 0);
+    EXPECT_RANGE_EQ(view, list);
+  }
+  EXPECT_TRUE(reader.done());
+}
+
+TEST(ValueVerifiedSBOVector, MustRejectMalformedInput) {
+  const auto lists = MakeLists<int32_t, SBO_SIZE>();
+  const auto bytes = SerializeLists(lists);
+  const auto aligned = AlignedCopy<int32_t>(bytes);
+  SBOVectorView<int32_t> view;
+  {  // truncated
+    SerializedSBOVectorReader<int32_t> reader(aligned.data(), bytes.size() - 8);
+    while (reader.next(view)) {
+    }
+    EXPECT_TRUE(reader.failed());
+  }
+  {  // count larger than the buffer
+    auto corrupt = aligned;
+    const uint64_t huge = ~uint64_t{0};
+    std::memcpy(corrupt.data(), &huge, sizeof(huge));
+    SerializedSBOVectorReader<int32_t> reader(corrupt.data(), bytes.size());
+    EXPECT_FALSE(reader.next(view));
+    EXPECT_TRUE(reader.failed());
+  }
+  {  // misaligned buffer
+    SerializedSBOVectorReader<int32_t> reader(
+      reinterpret_cast<const char*>(aligned.data()) + 4, bytes.size() - 4);
+    EXPECT_FALSE(reader.next(view));
+    EXPECT_TRUE(reader.failed());
+  }
+}
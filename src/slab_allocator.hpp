@@ -0,0 +1,201 @@
+#ifndef SLAB_ALLOCATOR_HPP
+#define SLAB_ALLOCATOR_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+// Arena serving the spill buffers of a bulk built collection from a few large slabs
+//
+// allocate() bumps a pointer through the current slab, deallocate() returns the block to a
+// per size class free list; blocks too big to pool get their own slab, freed on deallocate.
+// Nothing else goes back to the system until the arena dies, so it must outlive every
+// container allocating from it.
+// Single threaded: one arena per building thread.
+class SlabArena {
+  // size classes: 16 byte steps up to 128 bytes, then 4 classes per doubling up to
+  // kMaxPooledBlock (at most 25% rounding waste, blocks stay 16 byte aligned)
+  static constexpr size_t kMinBlock = 16;
+  static constexpr size_t kLinearClasses = 8;
+  static constexpr size_t kLinearShift = 7;
+  static constexpr size_t kMaxPooledShift = 16;
+  static constexpr size_t kMaxPooledBlock = size_t{1} << kMaxPooledShift;
+  static constexpr size_t kSizeClasses = kLinearClasses + (kMaxPooledShift - kLinearShift) * 4;
+
+  struct FreeBlock {
+    FreeBlock* next_;
+  };
+
+  // every slab starts with a header linking it into slabs_ (no container to grow, so
+  // allocate() never throws), oversize slabs are unlinked again on deallocate
+  struct alignas(std::max_align_t) SlabHeader {
+    SlabHeader* prev_;
+    SlabHeader* next_;
+    size_t bytes_;
+  };
+
+  size_t slab_bytes_;
+  SlabHeader* slabs_;
+  size_t slab_count_;
+  std::byte* cursor_;
+  std::byte* slab_end_;
+  std::array<FreeBlock*, kSizeClasses> free_lists_;
+  size_t reserved_bytes_;
+
+  static size_t size_class(size_t bytes) noexcept {
+    if (bytes <= kMinBlock * kLinearClasses) {
+      return bytes <= kMinBlock ? 0 : (bytes + kMinBlock - 1) / kMinBlock - 1;
+    }
+    // bytes in (2^shift, 2^(shift + 1)], split in 4 steps
+    size_t shift = kLinearShift;
+    while ((size_t{2} << shift) < bytes) {
+      ++shift;
+    }
+    const auto step = size_t{1} << (shift - 2);
+    const auto sub = (bytes - (size_t{1} << shift) + step - 1) / step - 1;
+    return kLinearClasses + (shift - kLinearShift) * 4 + sub;
+  }
+
+  static size_t block_size(size_t index) noexcept {
+    if (index < kLinearClasses) {
+      return kMinBlock * (index + 1);
+    }
+    const auto shift = kLinearShift + (index - kLinearClasses) / 4;
+    const auto sub = (index - kLinearClasses) % 4;
+    return (size_t{1} << shift) + (sub + 1) * (size_t{1} << (shift - 2));
+  }
+
+  std::byte* new_slab(size_t bytes) noexcept {
+    const auto words = (bytes + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t);
+    const auto slab_bytes = words * sizeof(std::max_align_t);
+    auto memory = ::operator new(sizeof(SlabHeader) + slab_bytes, std::nothrow);
+    if (!memory) {
+      return nullptr;
+    }
+    auto slab = new (memory) SlabHeader{nullptr, slabs_, slab_bytes};
+    if (slabs_) {
+      slabs_->prev_ = slab;
+    }
+    slabs_ = slab;
+    ++slab_count_;
+    reserved_bytes_ += slab_bytes;
+    return static_cast<std::byte*>(static_cast<void*>(slab + 1));
+  }
+
+  void free_slab(SlabHeader* slab) noexcept {
+    if (slab->prev_) {
+      slab->prev_->next_ = slab->next_;
+    } else {
+      slabs_ = slab->next_;
+    }
+    if (slab->next_) {
+      slab->next_->prev_ = slab->prev_;
+    }
+    --slab_count_;
+    reserved_bytes_ -= slab->bytes_;
+    ::operator delete(slab);
+  }
+
+ public:
+  static constexpr size_t kDefaultSlabBytes = size_t{1} << 20;
+
+  explicit SlabArena(size_t slab_bytes = kDefaultSlabBytes) noexcept
+      : slab_bytes_(std::max(slab_bytes, kMaxPooledBlock)),
+        slabs_(nullptr),
+        slab_count_(0),
+        cursor_(nullptr),
+        slab_end_(nullptr),
+        free_lists_{},
+        reserved_bytes_(0) {}
+
+  SlabArena(const SlabArena&) = delete;
+  SlabArena& operator=(const SlabArena&) = delete;
+
+  ~SlabArena() {
+    while (slabs_) {
+      free_slab(slabs_);
+    }
+  }
+
+  // bytes held from the system (slab headers excluded)
+  [[nodiscard]] size_t reserved_bytes() const noexcept { return reserved_bytes_; }
+  [[nodiscard]] size_t slab_count() const noexcept { return slab_count_; }
+
+  // returns nullptr on failure, alignment up to alignof(std::max_align_t)
+  void* allocate(size_t bytes) noexcept {
+    if (bytes > kMaxPooledBlock) {
+      // own slab, freed on deallocate
+      return new_slab(bytes);
+    }
+    const auto index = size_class(bytes);
+    if (auto block = free_lists_[index]) {
+      free_lists_[index] = block->next_;
+      return block;
+    }
+    const auto block_bytes = block_size(index);
+    if (static_cast<size_t>(slab_end_ - cursor_) < block_bytes) {
+      // the tail of the old slab is abandoned, at most kMaxPooledBlock bytes
+      cursor_ = new_slab(slab_bytes_);
+      if (!cursor_) {
+        slab_end_ = nullptr;
+        return nullptr;
+      }
+      slab_end_ = cursor_ + slab_bytes_;
+    }
+    auto out = cursor_;
+    cursor_ += block_bytes;
+    return out;
+  }
+
+  void deallocate(void* p, size_t bytes) noexcept {
+    if (bytes > kMaxPooledBlock) {
+      free_slab(static_cast<SlabHeader*>(p) - 1);
+      return;
+    }
+    const auto index = size_class(bytes);
+    free_lists_[index] = new (p) FreeBlock{free_lists_[index]};
+  }
+};
+
+// std allocator interface over a SlabArena (eg: SBOVector<int, 8, SlabAllocator<int>>)
+template <typename T>
+struct SlabAllocator {
+  static_assert(alignof(T) <= alignof(std::max_align_t));
+
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using size_type = size_t;
+
+  using is_always_equal = std::false_type;
+
+  template <typename U>
+  struct rebind {
+    using other = SlabAllocator<U>;
+  };
+
+  SlabArena* arena_;
+
+  explicit SlabAllocator(SlabArena& arena) noexcept : arena_(&arena) {}
+
+  template <typename U>
+  SlabAllocator(const SlabAllocator<U>& other) noexcept : arena_(other.arena_) {}
+
+  pointer allocate(size_t n, const void*) { return allocate(n); }
+  pointer allocate(size_t n) { return static_cast<pointer>(arena_->allocate(n * sizeof(T))); }
+
+  void deallocate(pointer p, size_t n) noexcept { arena_->deallocate(p, n * sizeof(T)); }
+
+  template <typename U>
+  bool operator==(const SlabAllocator<U>& other) const noexcept {
+    return arena_ == other.arena_;
+  }
+  template <typename U>
+  bool operator!=(const SlabAllocator<U>& other) const noexcept {
+    return arena_ != other.arena_;
+  }
+};
+
+#endif  // SLAB_ALLOCATOR_HPP
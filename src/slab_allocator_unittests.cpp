@@ -0,0 +1,77 @@
+#include "unittest_common.hpp"
+
+#include "slab_allocator.hpp"
+
+// Unittests for SlabArena/SlabAllocator
+
+TEST(ValueVerifiedSlabAllocator, MustReuseFreedBlocks) {
+  SlabArena arena;
+  auto a = arena.allocate(SMALL_SIZE);
+  auto b = arena.allocate(SMALL_SIZE);
+  EXPECT_NE(a, b);
+  arena.deallocate(a, SMALL_SIZE);
+  // same size class
+  EXPECT_EQ(arena.allocate(SMALL_SIZE + 1), a);
+  EXPECT_EQ(arena.slab_count(), 1u);
+  EXPECT_EQ(arena.reserved_bytes(), SlabArena::kDefaultSlabBytes);
+
+  // too big to pool: own slab, freed on deallocate
+  auto huge = arena.allocate(SlabArena::kDefaultSlabBytes * 2);
+  ASSERT_NE(huge, nullptr);
+  EXPECT_EQ(arena.slab_count(), 2u);
+  EXPECT_EQ(arena.reserved_bytes(), SlabArena::kDefaultSlabBytes * 3);
+  arena.deallocate(huge, SlabArena::kDefaultSlabBytes * 2);
+  EXPECT_EQ(arena.slab_count(), 1u);
+  EXPECT_EQ(arena.reserved_bytes(), SlabArena::kDefaultSlabBytes);
+
+  // freed out of allocation order, the pooling slab keeps serving
+  auto first = arena.allocate(SlabArena::kDefaultSlabBytes);
+  auto second = arena.allocate(SlabArena::kDefaultSlabBytes);
+  ASSERT_NE(first, nullptr);
+  ASSERT_NE(second, nullptr);
+  EXPECT_EQ(arena.slab_count(), 3u);
+  arena.deallocate(first, SlabArena::kDefaultSlabBytes);
+  arena.deallocate(second, SlabArena::kDefaultSlabBytes);
+  EXPECT_EQ(arena.slab_count(), 1u);
+  EXPECT_NE(arena.allocate(SMALL_SIZE), nullptr);
+  EXPECT_EQ(arena.slab_count(), 1u);
+}
+
+TEST(ValueVerifiedSlabAllocator, MustServeSBOVectorSpills) {
+  SlabArena arena;
+  using Vector = SBOVector<int, SMALL_SIZE, SlabAllocator<int>>;
+  std::vector<Vector> vectors;
+  for (auto i = 0u; i < LARGE_SIZE * 10; ++i) {
+    vectors.emplace_back(SlabAllocator<int>(arena));
+    for (auto j = 0; j < static_cast<int>(i % LARGE_SIZE); ++j) {
+      vectors.back().push_back(j);
+    }
+  }
+  for (auto i = 0u; i < vectors.size(); ++i) {
+    ASSERT_EQ(vectors[i].size(), i % LARGE_SIZE);
+    for (auto j = 0u; j < vectors[i].size(); ++j) {
+      ASSERT_EQ(vectors[i][j], static_cast<int>(j));
+    }
+  }
+  // ~1000 spilled vectors, every growth step returned to the free lists
+  EXPECT_EQ(arena.slab_count(), 1u);
+
+  // copies allocate from the same arena
+  auto copy = vectors.back();
+  EXPECT_TRUE(copy.get_allocator() == vectors.back().get_allocator());
+  EXPECT_RANGE_EQ(copy, vectors.back());
+}
+
+TEST_F(DataTypeOperationTrackingSBOVector, MustDestroySlabAllocatedSBOVector) {
+  SlabArena arena;
+  {
+    SBOVector<DataType, SBO_SIZE, SlabAllocator<DataType>> sbo{SlabAllocator<DataType>(arena)};
+    for (auto i = 0u; i < LARGE_SIZE; ++i) {
+      sbo.emplace_back();
+    }
+    UseElements(sbo);
+    sbo.erase(sbo.begin(), sbo.begin() + (LARGE_SIZE - SMALL_SIZE));
+    UseElements(sbo);
+  }
+  EXPECT_EQ(OperationCounter::TOTALS.copies(), 0);
+}
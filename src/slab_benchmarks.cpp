@@ -0,0 +1,108 @@
+#include "benchmark_common.hpp"
+
+#include "sbovector.hpp"
+#include "slab_allocator.hpp"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+// Bulk building 1M SBOVector<int, 8> from parsed records (30% spill, 9 to 64 elements)
+// Std: std::allocator, one allocate() per spilled vector
+// Slab: SlabAllocator over a SlabArena owned next to the collection
+// Build: construction time + RSS of the built collection, Destroy: destruction time
+
+namespace {
+
+constexpr size_t kVectors = 1 << 20;
+constexpr size_t kInline = 8;
+
+struct Records {
+  std::vector<int> values_;
+  std::vector<size_t> sizes_;
+};
+
+const Records& GetRecords() {
+  static const Records records = []() {
+    std::mt19937 random(42);
+    Records out;
+    out.values_.resize(64);
+    for (auto i = 0u; i < out.values_.size(); ++i) {
+      out.values_[i] = static_cast<int>(i);
+    }
+    for (size_t i = 0; i < kVectors; ++i) {
+      out.sizes_.push_back(random() % 10 < 3 ? kInline + 1 + random() % 56 : random() % (kInline + 1));
+    }
+    return out;
+  }();
+  return records;
+}
+
+struct StdCollection {
+  std::vector<SBOVector<int, kInline>> vectors_;
+
+  void add(const int* first, const int* last) {
+    vectors_.emplace_back();
+    vectors_.back().insert(vectors_.back().end(), first, last);
+  }
+};
+
+struct SlabCollection {
+  // declared first: outlives the vectors
+  std::unique_ptr<SlabArena> arena_ = std::make_unique<SlabArena>();
+  std::vector<SBOVector<int, kInline, SlabAllocator<int>>> vectors_;
+
+  void add(const int* first, const int* last) {
+    vectors_.emplace_back(SlabAllocator<int>(*arena_));
+    vectors_.back().insert(vectors_.back().end(), first, last);
+  }
+};
+
+template <typename Collection>
+std::unique_ptr<Collection> Build() {
+  const auto& records = GetRecords();
+  auto out = std::make_unique<Collection>();
+  out->vectors_.reserve(kVectors);
+  for (auto size : records.sizes_) {
+    out->add(records.values_.data(), records.values_.data() + size);
+  }
+  return out;
+}
+
+template <typename Collection>
+void RunBuild(benchmark::State& state) {
+  GetRecords();
+  for (auto _ : state) {
+    ScopedRSSCounters rss_counters;
+    auto collection = Build<Collection>();
+    state.PauseTiming();
+    rss_counters.Report(state);
+    collection.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kVectors));
+}
+
+template <typename Collection>
+void RunDestroy(benchmark::State& state) {
+  GetRecords();
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto collection = Build<Collection>();
+    state.ResumeTiming();
+    collection.reset();
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(kVectors));
+}
+
+}  // namespace
+
+static void BM_BulkBuildStdAllocator(benchmark::State& state) { RunBuild<StdCollection>(state); }
+static void BM_BulkBuildSlabAllocator(benchmark::State& state) { RunBuild<SlabCollection>(state); }
+static void BM_BulkDestroyStdAllocator(benchmark::State& state) { RunDestroy<StdCollection>(state); }
+static void BM_BulkDestroySlabAllocator(benchmark::State& state) { RunDestroy<SlabCollection>(state); }
+
+BENCHMARK(BM_BulkBuildStdAllocator)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BulkBuildSlabAllocator)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BulkDestroyStdAllocator)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_BulkDestroySlabAllocator)->Unit(benchmark::kMillisecond);
@@ -0,0 +1,195 @@
+#include "benchmark_common.hpp"
+
+#include "sbovector.hpp"
+#include "spsc_queue.hpp"
+
+#include <mutex>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Handing ints between two pinned threads (cpu 0 and 1, or both on 0 if single core)
+// PingPong: one round trip per iteration through a pair of queues (latency)
+// Throughput: a producer streams batches of range(0) ints to a consumer (items/s)
+// MutexSBOVector: SBOVector behind a std::mutex, the consumer swaps out everything per lock
+
+namespace {
+
+constexpr size_t kQueueSize = 1024;
+constexpr int kStreamCount = 1 << 22;
+
+void PinToCpu(std::thread& thread, unsigned cpu) {
+#if defined(__linux__)
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu % std::max(1u, std::thread::hardware_concurrency()), &set);
+  pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set);
+#else
+  static_cast<void>(thread);
+  static_cast<void>(cpu);
+#endif
+}
+
+// spins briefly then yields, so two threads sharing a core still make progress
+class Backoff {
+  unsigned spins_ = 0;
+
+ public:
+  void operator()() {
+    if (++spins_ > 64) {
+      std::this_thread::yield();
+    }
+  }
+};
+
+class MutexQueue {
+  std::mutex mutex_;
+  SBOVector<int, kQueueSize> values_;
+  // consumer side: the batch taken by the last swap
+  SBOVector<int, kQueueSize> taken_;
+  size_t read_ = 0;
+
+ public:
+  size_t push_n(const int* values, size_t count) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    values_.insert(values_.end(), values, values + count);
+    return count;
+  }
+
+  size_t pop_n(int* out, size_t max_count) {
+    if (read_ == taken_.size()) {
+      taken_.clear();
+      read_ = 0;
+      std::lock_guard<std::mutex> lock(mutex_);
+      values_.swap(taken_);
+    }
+    const auto n = std::min(max_count, taken_.size() - read_);
+    std::copy_n(taken_.begin() + static_cast<ptrdiff_t>(read_), n, out);
+    read_ += n;
+    return n;
+  }
+};
+
+using SpscQueue = SBOSpscQueue<int, kQueueSize>;
+
+template <typename Queue>
+void Send(Queue& queue, const int* values, size_t count) {
+  Backoff backoff;
+  for (size_t sent = 0; sent < count;) {
+    const auto n = queue.push_n(values + sent, count - sent);
+    if (n == 0) {
+      backoff();
+    }
+    sent += n;
+  }
+}
+
+template <typename Queue>
+int Receive(Queue& queue) {
+  Backoff backoff;
+  int value;
+  while (queue.pop_n(&value, 1) == 0) {
+    backoff();
+  }
+  return value;
+}
+
+template <typename Queue>
+void RunPingPong(benchmark::State& state) {
+  Queue ping;
+  Queue pong;
+  std::thread echo([&]() {
+    for (auto value = Receive(ping); value >= 0; value = Receive(ping)) {
+      Send(pong, &value, 1);
+    }
+  });
+  PinToCpu(echo, 1);
+  int value = 0;
+  for (auto _ : state) {
+    Send(ping, &value, 1);
+    value = Receive(pong) + 1;
+  }
+  const int stop = -1;
+  Send(ping, &stop, 1);
+  echo.join();
+}
+
+template <typename Queue>
+void RunThroughput(benchmark::State& state) {
+  const auto batch = static_cast<size_t>(state.range(0));
+  for (auto _ : state) {
+    Queue queue;
+    std::thread producer([&]() {
+      std::vector<int> values(batch);
+      for (size_t i = 0; i < kStreamCount; i += batch) {
+        std::iota(values.begin(), values.end(), static_cast<int>(i));
+        Send(queue, values.data(), batch);
+      }
+    });
+    PinToCpu(producer, 1);
+    std::vector<int> out(kQueueSize);
+    int64_t sum = 0;
+    Backoff backoff;
+    for (size_t received = 0; received < kStreamCount;) {
+      const auto n = queue.pop_n(out.data(), out.size());
+      if (n == 0) {
+        backoff();
+      }
+      for (size_t i = 0; i < n; ++i) {
+        sum += out[i];
+      }
+      received += n;
+    }
+    producer.join();
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() * kStreamCount);
+}
+
+// pins the benchmark thread itself to cpu 0
+template <typename Fn>
+void Pinned(benchmark::State& state, Fn&& fn) {
+#if defined(__linux__)
+  cpu_set_t previous;
+  pthread_getaffinity_np(pthread_self(), sizeof(previous), &previous);
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(0, &set);
+  pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+  fn(state);
+  pthread_setaffinity_np(pthread_self(), sizeof(previous), &previous);
+#else
+  fn(state);
+#endif
+}
+
+}  // namespace
+
+static void BM_PingPongMutexSBOVector(benchmark::State& state) {
+  Pinned(state, RunPingPong<MutexQueue>);
+}
+
+static void BM_PingPongSBOSpscQueue(benchmark::State& state) {
+  Pinned(state, RunPingPong<SpscQueue>);
+}
+
+static void BM_ThroughputMutexSBOVector(benchmark::State& state) {
+  Pinned(state, RunThroughput<MutexQueue>);
+}
+
+static void BM_ThroughputSBOSpscQueue(benchmark::State& state) {
+  Pinned(state, RunThroughput<SpscQueue>);
+}
+
+BENCHMARK(BM_PingPongMutexSBOVector)->UseRealTime();
+BENCHMARK(BM_PingPongSBOSpscQueue)->UseRealTime();
+// batch sizes: single element, one cache line of ints, bulk
+BENCHMARK(BM_ThroughputMutexSBOVector)->Arg(1)->Arg(16)->Arg(256)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
+BENCHMARK(BM_ThroughputSBOSpscQueue)->Arg(1)->Arg(16)->Arg(256)
+    ->Unit(benchmark::kMillisecond)->UseRealTime();
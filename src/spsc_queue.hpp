@@ -0,0 +1,311 @@
+#ifndef SPSC_QUEUE_HPP
+#define SPSC_QUEUE_HPP
+
+#include "sbovector.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <utility>
+
+namespace details_ {
+
+// std::hardware_destructive_interference_size is not reliably available
+constexpr size_t kCacheLineSize = 64;
+
+constexpr size_t NextPowerOfTwo(size_t value) {
+  size_t out = 1;
+  while (out < value) {
+    out <<= 1;
+  }
+  return out;
+}
+
+// One ring of the queue: head_ is written by the consumer only, tail_ by the producer only,
+// next_ links the ring the producer moved on to (set once the producer stops writing here)
+template <typename DataType>
+struct SpscRing {
+  DataType* slots_;
+  size_t mask_;
+  std::atomic<SpscRing*> next_{nullptr};
+  alignas(kCacheLineSize) std::atomic<size_t> head_{0};
+  alignas(kCacheLineSize) std::atomic<size_t> tail_{0};
+
+  SpscRing(DataType* slots, size_t capacity) noexcept : slots_(slots), mask_(capacity - 1) {}
+
+  size_t capacity() const noexcept { return mask_ + 1; }
+
+  void reset() noexcept {
+    next_.store(nullptr, std::memory_order_relaxed);
+    head_.store(0, std::memory_order_relaxed);
+    tail_.store(0, std::memory_order_relaxed);
+  }
+};
+
+}  // namespace details_
+
+// Single producer single consumer FIFO queue over an inline power of two ring
+//
+// Indices only ever grow (slot = index & mask), the producer owns tail_, the consumer owns
+// head_ and each keeps a cached copy of the other's index so the shared cache lines are only
+// touched when the cached view runs out. Bulk push_n/pop_n copy at most two contiguous spans.
+//
+// Overflow = false: push fails (try_push returns false, push_n pushes less) when the ring is full
+// Overflow = true: when full, the producer spills into a heap ring (at least twice the size)
+// linked after the current one; the consumer follows the chain and frees drained heap rings,
+// the producer moves back to the inline ring once the consumer has caught up with it.
+//
+// Concurrency: one producer thread (try_push/try_emplace/push_n), one consumer thread
+// (try_pop/pop_n/empty)
+template <
+  typename DataType,
+  size_t BufferSize,
+  typename Allocator = std::allocator<DataType>,
+  bool Overflow = false
+>
+class SBOSpscQueue {
+  static_assert(BufferSize > 0 && (BufferSize & (BufferSize - 1)) == 0,
+                "BufferSize must be a power of two");
+
+  using Ring = details_::SpscRing<DataType>;
+
+  // producer side
+  alignas(details_::kCacheLineSize) Ring* producer_ring_;
+  size_t cached_head_;
+  // consumer side
+  alignas(details_::kCacheLineSize) Ring* consumer_ring_;
+  size_t cached_tail_;
+
+  alignas(details_::kCacheLineSize) Ring inline_ring_;
+  std::array<details_::AlignedStorage<DataType>, BufferSize> inline_;
+  Allocator alloc_;
+
+  // producer: contiguous free slots starting at tail, at most wanted
+  size_t writable(Ring* ring, size_t tail, size_t wanted) noexcept {
+    auto free = ring->capacity() - (tail - cached_head_);
+    if (free < wanted) {
+      cached_head_ = ring->head_.load(std::memory_order_acquire);
+      free = ring->capacity() - (tail - cached_head_);
+    }
+    return std::min(free, wanted);
+  }
+
+  // consumer: readable slots starting at head, at most wanted
+  size_t readable(Ring* ring, size_t head, size_t wanted) noexcept {
+    auto available = cached_tail_ - head;
+    if (available < wanted) {
+      cached_tail_ = ring->tail_.load(std::memory_order_acquire);
+      available = cached_tail_ - head;
+    }
+    return std::min(available, wanted);
+  }
+
+  // producer: moves back to the inline ring once the consumer drained the heap ring
+  void return_to_inline(Ring* ring, size_t tail) noexcept {
+    if (ring == &inline_ring_ || ring->head_.load(std::memory_order_acquire) != tail) {
+      return;
+    }
+    // the heap ring held elements which the consumer popped, so it has left the inline ring
+    inline_ring_.reset();
+    ring->next_.store(&inline_ring_, std::memory_order_release);
+    producer_ring_ = &inline_ring_;
+    cached_head_ = 0;
+  }
+
+  // producer: links a heap ring able to take at least count elements
+  bool spill(size_t count) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    const auto capacity = std::max(producer_ring_->capacity() * 2,
+                                   details_::NextPowerOfTwo(count));
+    auto slots = alloc_.allocate(capacity);
+    if (!slots) {
+      SBOVECTOR_ASSERT(!SBOVECTOR_SHOULD_THROW_BAD_ALLOC, SBOVEC_OOM);
+      SBOVECTOR_DO_BAD_ALLOC_THROW();
+      return false;
+    }
+    auto ring = new Ring(slots, capacity);
+    producer_ring_->next_.store(ring, std::memory_order_release);
+    producer_ring_ = ring;
+    cached_head_ = 0;
+    return true;
+  }
+
+  // consumer: follows next_ once the current ring is drained
+  bool advance() noexcept {
+    auto ring = consumer_ring_;
+    auto next = ring->next_.load(std::memory_order_acquire);
+    if (!next) {
+      return false;
+    }
+    // elements written before the link are visible now
+    cached_tail_ = ring->tail_.load(std::memory_order_acquire);
+    if (cached_tail_ != ring->head_.load(std::memory_order_relaxed)) {
+      return true;
+    }
+    consumer_ring_ = next;
+    cached_tail_ = 0;
+    if (ring != &inline_ring_) {
+      free_ring(ring);
+    }
+    return true;
+  }
+
+  void free_ring(Ring* ring) noexcept {
+    alloc_.deallocate(ring->slots_, ring->capacity());
+    delete ring;
+  }
+
+  template <typename... Args>
+  bool emplace_impl(Args&&... args) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    auto ring = producer_ring_;
+    auto tail = ring->tail_.load(std::memory_order_relaxed);
+    if constexpr (Overflow) {
+      return_to_inline(ring, tail);
+      if (ring != producer_ring_) {
+        ring = producer_ring_;
+        tail = 0;
+      }
+    }
+    if (writable(ring, tail, 1) == 0) {
+      if constexpr (!Overflow) {
+        return false;
+      } else {
+        if (!spill(1)) {
+          return false;
+        }
+        ring = producer_ring_;
+        tail = 0;
+      }
+    }
+    new (ring->slots_ + (tail & ring->mask_)) DataType(std::forward<Args>(args)...);
+    ring->tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+ public:
+  using value_type = DataType;
+  using allocator_type = Allocator;
+  using size_type = size_t;
+
+  SBOSpscQueue() noexcept : SBOSpscQueue(Allocator()) {}
+
+  explicit SBOSpscQueue(const Allocator& alloc) noexcept
+      : producer_ring_(&inline_ring_),
+        cached_head_(0),
+        consumer_ring_(&inline_ring_),
+        cached_tail_(0),
+        inline_ring_(reinterpret_cast<DataType*>(inline_.data()), BufferSize),
+        alloc_(alloc) {}
+
+  SBOSpscQueue(const SBOSpscQueue&) = delete;
+  SBOSpscQueue& operator=(const SBOSpscQueue&) = delete;
+
+  // requires both threads to have stopped using the queue
+  ~SBOSpscQueue() {
+    auto ring = consumer_ring_;
+    while (ring) {
+      const auto head = ring->head_.load();
+      const auto tail = ring->tail_.load();
+      for (auto i = head; i != tail; ++i) {
+        std::destroy_at(ring->slots_ + (i & ring->mask_));
+      }
+      auto next = ring->next_.load();
+      if (ring != &inline_ring_) {
+        free_ring(ring);
+      }
+      ring = next;
+    }
+  }
+
+  [[nodiscard]] static constexpr size_t inline_capacity() noexcept { return BufferSize; }
+
+  // Producer
+  bool try_push(const DataType& value) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return emplace_impl(value);
+  }
+
+  bool try_push(DataType&& value) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return emplace_impl(std::move(value));
+  }
+
+  template <typename... Args>
+  bool try_emplace(Args&&... args) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    return emplace_impl(std::forward<Args>(args)...);
+  }
+
+  // Producer: copies up to count values (all of them if Overflow), returns the number pushed
+  size_t push_n(const DataType* values, size_t count) SBOVECTOR_NOEXCEPT_COND_ALLOC {
+    size_t pushed = 0;
+    if constexpr (Overflow) {
+      return_to_inline(producer_ring_, producer_ring_->tail_.load(std::memory_order_relaxed));
+    }
+    while (true) {
+      auto ring = producer_ring_;
+      const auto tail = ring->tail_.load(std::memory_order_relaxed);
+      const auto n = writable(ring, tail, count - pushed);
+      const auto offset = tail & ring->mask_;
+      const auto first = std::min(n, ring->capacity() - offset);
+      std::uninitialized_copy_n(values + pushed, first, ring->slots_ + offset);
+      std::uninitialized_copy_n(values + pushed + first, n - first, ring->slots_);
+      ring->tail_.store(tail + n, std::memory_order_release);
+      pushed += n;
+      if constexpr (Overflow) {
+        if (pushed < count && spill(count - pushed)) {
+          continue;
+        }
+      }
+      return pushed;
+    }
+  }
+
+  // Consumer
+  bool try_pop(DataType& out) noexcept(std::is_nothrow_move_assignable_v<DataType>) {
+    return pop_n(&out, 1) == 1;
+  }
+
+  // Consumer: moves up to max_count elements into out, returns the number popped
+  size_t pop_n(DataType* out, size_t max_count) noexcept(std::is_nothrow_move_assignable_v<DataType>) {
+    size_t popped = 0;
+    while (popped < max_count) {
+      auto ring = consumer_ring_;
+      const auto head = ring->head_.load(std::memory_order_relaxed);
+      const auto n = readable(ring, head, max_count - popped);
+      if (n == 0) {
+        if constexpr (Overflow) {
+          if (advance()) {
+            continue;
+          }
+        }
+        break;
+      }
+      const auto offset = head & ring->mask_;
+      const auto first = std::min(n, ring->capacity() - offset);
+      auto src = ring->slots_ + offset;
+      std::move(src, src + first, out + popped);
+      std::destroy_n(src, first);
+      std::move(ring->slots_, ring->slots_ + (n - first), out + popped + first);
+      std::destroy_n(ring->slots_, n - first);
+      ring->head_.store(head + n, std::memory_order_release);
+      popped += n;
+    }
+    return popped;
+  }
+
+  // Consumer: true if nothing can currently be popped
+  [[nodiscard]] bool empty() noexcept {
+    while (true) {
+      auto ring = consumer_ring_;
+      if (readable(ring, ring->head_.load(std::memory_order_relaxed), 1) != 0) {
+        return false;
+      }
+      if constexpr (Overflow) {
+        if (advance()) {
+          continue;
+        }
+      }
+      return true;
+    }
+  }
+};
+
+#endif  // SPSC_QUEUE_HPP
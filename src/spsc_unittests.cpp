@@ -0,0 +1,128 @@
+#include "unittest_common.hpp"
+
+#include "spsc_queue.hpp"
+
+#include <thread>
+
+// Unittests for SBOSpscQueue
+
+namespace {
+
+constexpr size_t QUEUE_SIZE = 16;
+static_assert(QUEUE_SIZE >= SBO_SIZE);
+
+}  // namespace
+
+TEST(ValueVerifiedSBOSpscQueue, MustPushAndPopInOrder) {
+  SBOSpscQueue<int, QUEUE_SIZE> queue;
+  EXPECT_TRUE(queue.empty());
+  for (auto i = 0; i < static_cast<int>(QUEUE_SIZE); ++i) {
+    EXPECT_TRUE(queue.try_push(i));
+  }
+  // full without overflow
+  EXPECT_FALSE(queue.try_push(-1));
+  EXPECT_FALSE(queue.empty());
+  for (auto i = 0; i < static_cast<int>(QUEUE_SIZE); ++i) {
+    int value = -1;
+    EXPECT_TRUE(queue.try_pop(value));
+    EXPECT_EQ(value, i);
+  }
+  int value = -1;
+  EXPECT_FALSE(queue.try_pop(value));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(ValueVerifiedSBOSpscQueue, MustPushAndPopSpansAcrossTheWrap) {
+  SBOSpscQueue<int, QUEUE_SIZE> queue;
+  const auto values = make_vector_sequence<LARGE_SIZE>();
+  int out[LARGE_SIZE] = {};
+  // offset the indices so the next spans wrap around the end of the ring
+  EXPECT_EQ(queue.push_n(values.data(), SMALL_SIZE), SMALL_SIZE);
+  EXPECT_EQ(queue.pop_n(out, LARGE_SIZE), SMALL_SIZE);
+  // partial push when full
+  EXPECT_EQ(queue.push_n(values.data(), LARGE_SIZE), QUEUE_SIZE);
+  EXPECT_EQ(queue.push_n(values.data(), LARGE_SIZE), 0u);
+  // partial pop
+  EXPECT_EQ(queue.pop_n(out, SMALL_SIZE), SMALL_SIZE);
+  EXPECT_EQ(queue.pop_n(out + SMALL_SIZE, LARGE_SIZE), QUEUE_SIZE - SMALL_SIZE);
+  EXPECT_TRUE(std::equal(out, out + QUEUE_SIZE, values.begin()));
+}
+
+TEST(ValueVerifiedSBOSpscQueue, MustTransferAcrossThreads) {
+  constexpr int kCount = 200000;
+  SBOSpscQueue<int, QUEUE_SIZE> queue;
+  std::thread producer([&queue]() {
+    int batch[SMALL_SIZE];
+    for (auto i = 0; i < kCount;) {
+      const auto n = std::min(static_cast<int>(SMALL_SIZE), kCount - i);
+      for (auto j = 0; j < n; ++j) {
+        batch[j] = i + j;
+      }
+      const auto pushed = queue.push_n(batch, static_cast<size_t>(n));
+      if (pushed == 0) {
+        std::this_thread::yield();
+      }
+      i += static_cast<int>(pushed);
+    }
+  });
+  int expected = 0;
+  int out[SBO_SIZE];
+  while (expected < kCount) {
+    const auto n = queue.pop_n(out, SBO_SIZE);
+    if (n == 0) {
+      std::this_thread::yield();
+    }
+    for (auto i = 0u; i < n; ++i) {
+      ASSERT_EQ(out[i], expected++);
+    }
+  }
+  producer.join();
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(ValueVerifiedSBOSpscQueue, MustOverflowAcrossThreads) {
+  constexpr int kCount = 200000;
+  SBOSpscQueue<int, QUEUE_SIZE, std::allocator<int>, true> queue;
+  std::thread producer([&queue]() {
+    for (auto i = 0; i < kCount; ++i) {
+      EXPECT_TRUE(queue.try_push(i));
+    }
+  });
+  int expected = 0;
+  while (expected < kCount) {
+    int value = -1;
+    if (queue.try_pop(value)) {
+      ASSERT_EQ(value, expected++);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(DataTypeOperationTrackingSBOVector, MustOverflowSBOSpscQueue) {
+  SBOSpscQueue<DataType, QUEUE_SIZE, AllocatorType, true> queue(create_allocator());
+  std::vector<DataType> values(LARGE_SIZE);
+  EXPECT_EQ(queue.push_n(values.data(), LARGE_SIZE), LARGE_SIZE);
+  EXPECT_TRUE(queue.try_emplace());
+  EXPECT_EQ(totals_.allocs_, 1);
+
+  std::vector<DataType> out(LARGE_SIZE + 1);
+  EXPECT_EQ(queue.pop_n(out.data(), out.size()), LARGE_SIZE + 1);
+  UseElements(out);
+  // drained heap ring is only released when the consumer moves on
+  EXPECT_EQ(totals_.frees_, 0);
+
+  // consumer caught up: the producer returns to the inline ring, no new allocation
+  for (auto i = 0u; i < QUEUE_SIZE; ++i) {
+    EXPECT_TRUE(queue.try_emplace());
+  }
+  EXPECT_EQ(queue.pop_n(out.data(), out.size()), QUEUE_SIZE);
+  EXPECT_EQ(totals_.allocs_, 1);
+  EXPECT_EQ(totals_.frees_, 1);
+  EXPECT_TRUE(queue.empty());
+
+  // elements left in the queue are destroyed with it
+  EXPECT_EQ(queue.push_n(values.data(), SMALL_SIZE), SMALL_SIZE);
+}
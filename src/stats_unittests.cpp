@@ -0,0 +1,169 @@
+#include "unittest_common.hpp"
+
+#include "sbovector_stats.hpp"
+
+#include <sstream>
+#include <thread>
+
+// Unittests for the SBOVectorStats policy
+
+// (external linkage: GCC 12 reports a false -Warray-bounds on the inlined growth path of
+// SBOVectors of internal linkage types)
+struct StatsInstrumented {
+  int value_;
+};
+
+struct StatsPlain {
+  int value_;
+};
+
+namespace {
+
+using Instrumented = StatsInstrumented;
+using Plain = StatsPlain;
+
+constexpr bool NoStatsHooksAreConstantNoOps() {
+  SBOVectorNoStats::on_grow(LARGE_SIZE);
+  SBOVectorNoStats::on_spill(SBO_SIZE, SMALL_SIZE, SBO_SIZE);
+  SBOVectorNoStats::on_reallocate(LARGE_SIZE, SBO_SIZE, LARGE_SIZE);
+  SBOVectorNoStats::on_internalize(SMALL_SIZE);
+  SBOVectorNoStats::on_destroy(SMALL_SIZE);
+  return true;
+}
+
+// the storage layouts before stats policies existed (std::allocator is an empty base)
+template <typename DataType, size_t Capacity>
+struct RegularLayout {
+  size_t count_;
+  DataType* data_;
+  union {
+    std::array<details_::AlignedStorage<DataType>, Capacity> inline_;
+    size_t capacity_;
+  };
+};
+
+template <typename DataType, size_t Capacity>
+struct CompactLayout {
+  struct External {
+    DataType* data_;
+    size_t capacity_;
+  };
+  size_t count_;
+  union {
+    std::array<details_::AlignedStorage<DataType>, Capacity> inline_;
+    External external_;
+  };
+};
+
+}  // namespace
+
+template <>
+struct sbovector_stats_policy<Instrumented, SMALL_SIZE, std::allocator<Instrumented>, false> {
+  using type = SBOVectorStats<Instrumented, SMALL_SIZE, std::allocator<Instrumented>, false>;
+};
+
+namespace {
+
+using InstrumentedVector = SBOVector<Instrumented, SMALL_SIZE>;
+using Stats = SBOVectorStats<Instrumented, SMALL_SIZE, std::allocator<Instrumented>, false>;
+
+// the disabled policy adds no state and no runtime work, enabling it adds no state either
+static_assert(std::is_empty_v<SBOVectorNoStats>);
+static_assert(NoStatsHooksAreConstantNoOps());
+static_assert(sizeof(SBOVector<Plain, SMALL_SIZE>) == sizeof(RegularLayout<Plain, SMALL_SIZE>));
+static_assert(sizeof(CompactSBOVector<Plain, SMALL_SIZE>) ==
+              sizeof(CompactLayout<Plain, SMALL_SIZE>));
+static_assert(sizeof(InstrumentedVector) == sizeof(SBOVector<Plain, SMALL_SIZE>));
+static_assert(std::is_same_v<
+  sbovector_stats_policy<Plain, SMALL_SIZE, std::allocator<Plain>, false>::type,
+  SBOVectorNoStats
+>);
+
+}  // namespace
+
+TEST(ValueVerifiedStats, MustCountStorageTransitions) {
+  reset_sbovector_stats();
+  {
+    InstrumentedVector sbo;
+    for (auto i = 0u; i < LARGE_SIZE; ++i) {
+      sbo.push_back({static_cast<int>(i)});
+    }
+    sbo.erase(sbo.begin() + SMALL_SIZE, sbo.end());
+  }
+  const auto& stats = Stats::counters();
+  // capacity 5 -> 10 -> 20 -> 40 -> 80 -> 160 -> inline
+  EXPECT_EQ(stats.spills_, 1u);
+  EXPECT_EQ(stats.reallocations_, 4u);
+  EXPECT_EQ(stats.internalizations_, 1u);
+  EXPECT_EQ(stats.bytes_moved_, (5u + 10u + 20u + 40u + 80u + SMALL_SIZE) * sizeof(Instrumented));
+  EXPECT_EQ(stats.peak_size_, LARGE_SIZE);
+  EXPECT_EQ(stats.destroyed_, 1u);
+  EXPECT_EQ(stats.histogram_[details_::StatsHistogramBucket(SMALL_SIZE)], 1u);
+}
+
+TEST(ValueVerifiedStats, MustCountHandOverSwap) {
+  InstrumentedVector inlined(SMALL_SIZE, Instrumented{0});
+  InstrumentedVector external(LARGE_SIZE, Instrumented{0});
+  reset_sbovector_stats();
+  // external's buffer goes to inlined (a spill moving nothing), inlined's elements move into
+  // external's inline buffer (an internalization)
+  inlined.swap(external);
+  const auto& stats = Stats::counters();
+  EXPECT_EQ(stats.spills_, 1u);
+  EXPECT_EQ(stats.internalizations_, 1u);
+  EXPECT_EQ(stats.reallocations_, 0u);
+  EXPECT_EQ(stats.bytes_moved_, SMALL_SIZE * sizeof(Instrumented));
+}
+
+TEST(ValueVerifiedStats, MustReportAppendedSizeAsPeak) {
+  reset_sbovector_stats();
+  {
+    InstrumentedVector sbo;
+    // room for LARGE_SIZE, only SBO_SIZE written
+    sbo.append_uninitialized(LARGE_SIZE, [](Instrumented* tail, size_t) {
+      std::fill_n(tail, SBO_SIZE, Instrumented{1});
+      return SBO_SIZE;
+    });
+  }
+  EXPECT_EQ(Stats::counters().peak_size_, SBO_SIZE);
+}
+
+TEST(ValueVerifiedStats, MustAggregateAcrossThreads) {
+  reset_sbovector_stats();
+  std::vector<std::thread> threads;
+  for (auto t = 0; t < 4; ++t) {
+    threads.emplace_back([]() {
+      for (auto i = 0u; i < LARGE_SIZE; ++i) {
+        InstrumentedVector sbo;
+        for (auto j = 0u; j < SBO_SIZE; ++j) {
+          sbo.push_back({static_cast<int>(j)});
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  const auto& stats = Stats::counters();
+  EXPECT_EQ(stats.destroyed_, 4 * LARGE_SIZE);
+  EXPECT_EQ(stats.spills_, 4 * LARGE_SIZE);
+  EXPECT_EQ(stats.histogram_[details_::StatsHistogramBucket(SBO_SIZE)], 4 * LARGE_SIZE);
+}
+
+TEST(ValueVerifiedStats, MustDumpTextAndJson) {
+  reset_sbovector_stats();
+  {
+    InstrumentedVector sbo(LARGE_SIZE, Instrumented{0});
+  }
+  std::ostringstream text;
+  dump_sbovector_stats(text);
+  EXPECT_NE(text.str().find("StatsInstrumented, 5> destroyed: 1 spills: 1"), std::string::npos);
+  EXPECT_NE(text.str().find("[64..127]: 1"), std::string::npos);
+
+  std::ostringstream json;
+  dump_sbovector_stats(json, StatsFormat::kJson);
+  EXPECT_EQ(json.str().front(), '[');
+  EXPECT_NE(
+      json.str().find("\"buffer_size\": 5, \"element_size\": 4, \"destroyed\": 1, \"spills\": 1"),
+      std::string::npos);
+}
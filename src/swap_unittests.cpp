@@ -173,4 +173,42 @@ TEST_F(DataTypeOperationTrackingSBOVector, MustSwapAsymmetricAllocators) {
     UseElements(a);
     UseElements(b);
   }
-}
\ No newline at end of file
+}
+
+TEST_F(DataTypeOperationTrackingSBOVector, MustHandOverExternalBufferOnSwap) {
+  // inline <> external with equal allocators: the buffer changes hands, only inline elements move
+  for (auto swap_from_inline : {true, false}) {
+    ContainerType a(SMALL_SIZE, create_allocator());
+    ContainerType b(LARGE_SIZE, create_allocator());
+    const auto buffer = b.data();
+    const auto allocs = totals_.allocs_;
+    const auto moves = OperationCounter::TOTALS.moves();
+    if (swap_from_inline) {
+      a.swap(b);
+    } else {
+      b.swap(a);
+    }
+    EXPECT_EQ(totals_.allocs_, allocs);
+    EXPECT_LE(OperationCounter::TOTALS.moves() - moves, static_cast<int>(SMALL_SIZE));
+    EXPECT_EQ(a.data(), buffer);
+    EXPECT_EQ(a.size(), LARGE_SIZE);
+    EXPECT_EQ(a.capacity(), LARGE_SIZE);
+    EXPECT_EQ(b.size(), SMALL_SIZE);
+    EXPECT_EQ(b.capacity(), SBO_SIZE);
+    UseElements(a);
+    UseElements(b);
+  }
+}
+
+TEST(ValueVerifiedSBOVector, MustHandOverExternalBufferOnSwap) {
+  const auto small = make_vector_sequence<SMALL_SIZE>();
+  const auto large = make_vector_sequence<LARGE_SIZE>();
+  SBOVector<int, SBO_SIZE> a(small.begin(), small.end());
+  SBOVector<int, SBO_SIZE> b(large.begin(), large.end());
+  a.swap(b);
+  EXPECT_RANGE_EQ(a, large);
+  EXPECT_RANGE_EQ(b, small);
+  b.swap(a);
+  EXPECT_RANGE_EQ(a, small);
+  EXPECT_RANGE_EQ(b, large);
+}
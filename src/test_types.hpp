@@ -0,0 +1,37 @@
+#ifndef TEST_TYPES_HPP
+#define TEST_TYPES_HPP
+
+#include <memory>
+
+// Element types shared by the unittests and benchmarks
+
+using Trivial = int;
+class NonTrivial {
+ private:
+  std::unique_ptr<int> val_;
+
+ public:
+  NonTrivial() noexcept { val_ = std::make_unique<int>(42); }
+
+  ~NonTrivial() {}
+
+  NonTrivial(const NonTrivial&) noexcept : NonTrivial() {}
+
+  NonTrivial(NonTrivial&&) noexcept : NonTrivial() {}
+
+  NonTrivial& operator=(const NonTrivial&) noexcept { return *this; }
+
+  NonTrivial& operator=(NonTrivial&&) noexcept { return *this; }
+};
+
+class MoveOnly {
+ public:
+  MoveOnly() noexcept {}
+  ~MoveOnly() {}
+  MoveOnly(const MoveOnly&) = delete;
+  MoveOnly(MoveOnly&&) noexcept {}
+  MoveOnly& operator=(const MoveOnly&) = delete;
+  MoveOnly& operator=(MoveOnly&&) noexcept { return *this; }
+};
+
+#endif  // TEST_TYPES_HPP
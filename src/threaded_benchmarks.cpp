@@ -0,0 +1,384 @@
+#include "benchmark_common.hpp"
+
+#include "sbovector.hpp"
+#include "spsc_queue.hpp"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <new>
+#include <random>
+#include <thread>
+#include <vector>
+
+// Allocator scaling under threads: the contention SBOVector avoids by not allocating
+// Churn: every thread constructs, fills (30% spill past the 8 inline ints, up to 64) and
+// destroys vectors of its own
+// Handoff: thread i fills vectors and moves them through a queue to thread i + 1 (mod threads),
+// which destroys them: spilled buffers are freed on another thread than the one allocating
+// Containers: std::vector, SBOVector<int, 8> with std::allocator (Std), with a size class pool
+// with per thread caches (Pool, below) and over a std::pmr::synchronized_pool_resource (Pmr)
+// "items_per_thread" is the vectors per second of one thread, "scaling_efficiency" that rate
+// over the single thread run of the same benchmark (1 is perfect scaling; past the hardware
+// threads it measures oversubscription as well), eg:
+//   benchmarks --benchmark_filter='Churn<SBO8Pool>'
+
+namespace {
+
+constexpr size_t kInline = 8;
+constexpr size_t kBatch = 256;
+
+// Size class pool, one cache per thread
+//
+// Blocks are carved from 64KB chunks of their owner cache and carry a header naming it: a
+// thread frees to its own cache without synchronization, or pushes the block onto the owner's
+// remote list (lock free, drained by the owner when its local list runs out). Caches outlive
+// their threads: an exiting thread leaves its cache to the next one starting.
+namespace pool {
+
+constexpr size_t kMinBlock = 16;
+constexpr size_t kClasses = 9;  // 16 to 4096 bytes, larger requests go to operator new
+constexpr size_t kChunkSize = 64 * 1024;
+constexpr size_t kRefillBlocks = 32;
+
+struct ThreadCache;
+
+struct alignas(16) Header {
+  ThreadCache* owner_;  // nullptr: allocated by operator new
+  size_t size_class_;
+};
+
+struct FreeBlock {
+  FreeBlock* next_;
+};
+
+constexpr size_t BlockSize(size_t size_class) { return kMinBlock << size_class; }
+
+inline size_t SizeClass(size_t bytes) {
+  size_t out = 0;
+  while (out < kClasses && BlockSize(out) < bytes) {
+    ++out;
+  }
+  return out;
+}
+
+inline FreeBlock* AsBlock(Header* header) {
+  return static_cast<FreeBlock*>(static_cast<void*>(header + 1));
+}
+inline Header* HeaderOf(void* p) { return static_cast<Header*>(p) - 1; }
+
+struct ThreadCache {
+  std::array<FreeBlock*, kClasses> free_{};
+  std::atomic<FreeBlock*> remote_{nullptr};
+  std::vector<std::unique_ptr<std::byte[]>> chunks_;
+  size_t chunk_used_ = kChunkSize;
+
+  // carves up to kRefillBlocks blocks from the current chunk (the rest of it left for any class)
+  void Refill(size_t size_class) {
+    const auto stride = sizeof(Header) + BlockSize(size_class);
+    if (chunk_used_ + stride > kChunkSize) {
+      chunks_.emplace_back(new std::byte[kChunkSize]);
+      chunk_used_ = 0;
+    }
+    for (size_t i = 0; i < kRefillBlocks && chunk_used_ + stride <= kChunkSize; ++i) {
+      auto header = new (chunks_.back().get() + chunk_used_) Header{this, size_class};
+      auto block = AsBlock(header);
+      block->next_ = free_[size_class];
+      free_[size_class] = block;
+      chunk_used_ += stride;
+    }
+  }
+
+  void DrainRemote() {
+    auto block = remote_.exchange(nullptr, std::memory_order_acquire);
+    while (block) {
+      const auto next = block->next_;
+      const auto size_class = HeaderOf(block)->size_class_;
+      block->next_ = free_[size_class];
+      free_[size_class] = block;
+      block = next;
+    }
+  }
+
+  void* Allocate(size_t size_class) {
+    if (!free_[size_class]) {
+      DrainRemote();
+      if (!free_[size_class]) {
+        Refill(size_class);
+      }
+    }
+    auto block = free_[size_class];
+    free_[size_class] = block->next_;
+    return block;
+  }
+
+  void PushRemote(FreeBlock* block) {
+    block->next_ = remote_.load(std::memory_order_relaxed);
+    while (!remote_.compare_exchange_weak(block->next_, block, std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+    }
+  }
+};
+
+struct Caches {
+  std::mutex mutex_;
+  std::vector<std::unique_ptr<ThreadCache>> all_;
+  std::vector<ThreadCache*> idle_;
+};
+
+inline Caches& GetCaches() {
+  static Caches caches;
+  return caches;
+}
+
+// this thread's cache, taken from the idle ones (or created) on first use
+inline ThreadCache& LocalCache() {
+  struct Lease {
+    ThreadCache* cache_;
+    Lease() {
+      auto& caches = GetCaches();
+      std::lock_guard<std::mutex> lock(caches.mutex_);
+      if (caches.idle_.empty()) {
+        caches.all_.push_back(std::make_unique<ThreadCache>());
+        caches.idle_.push_back(caches.all_.back().get());
+      }
+      cache_ = caches.idle_.back();
+      caches.idle_.pop_back();
+    }
+    ~Lease() {
+      auto& caches = GetCaches();
+      std::lock_guard<std::mutex> lock(caches.mutex_);
+      caches.idle_.push_back(cache_);
+    }
+  };
+  static thread_local Lease lease;
+  return *lease.cache_;
+}
+
+inline void* Allocate(size_t bytes) {
+  const auto size_class = SizeClass(bytes);
+  if (size_class == kClasses) {
+    auto header = new (::operator new(sizeof(Header) + bytes)) Header{nullptr, kClasses};
+    return header + 1;
+  }
+  return LocalCache().Allocate(size_class);
+}
+
+inline void Deallocate(void* p) noexcept {
+  auto header = HeaderOf(p);
+  if (!header->owner_) {
+    ::operator delete(header);
+    return;
+  }
+  auto& local = LocalCache();
+  auto block = static_cast<FreeBlock*>(p);
+  if (header->owner_ == &local) {
+    block->next_ = local.free_[header->size_class_];
+    local.free_[header->size_class_] = block;
+  } else {
+    header->owner_->PushRemote(block);
+  }
+}
+
+}  // namespace pool
+
+template <typename T>
+struct PoolAllocator {
+  using value_type = T;
+  using pointer = T*;
+  using const_pointer = const T*;
+  using size_type = size_t;
+
+  using is_always_equal = std::true_type;
+
+  template <typename U>
+  struct rebind {
+    using other = PoolAllocator<U>;
+  };
+
+  PoolAllocator() noexcept = default;
+
+  template <typename U>
+  PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+  pointer allocate(size_t n) { return static_cast<pointer>(pool::Allocate(n * sizeof(T))); }
+  void deallocate(pointer p, size_t) noexcept { pool::Deallocate(p); }
+
+  template <typename U>
+  bool operator==(const PoolAllocator<U>&) const noexcept {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(const PoolAllocator<U>&) const noexcept {
+    return false;
+  }
+};
+
+std::pmr::synchronized_pool_resource& GetPmrResource() {
+  static std::pmr::synchronized_pool_resource resource;
+  return resource;
+}
+
+// Containers
+
+struct StdVectorStd {
+  using Vector = std::vector<int>;
+  static Vector Make() { return Vector(); }
+};
+
+struct SBO8Std {
+  using Vector = SBOVector<int, kInline>;
+  static Vector Make() { return Vector(); }
+};
+
+struct SBO8Pool {
+  using Vector = SBOVector<int, kInline, PoolAllocator<int>>;
+  static Vector Make() { return Vector(); }
+};
+
+struct SBO8Pmr {
+  using Vector = SBOVector<int, kInline, std::pmr::polymorphic_allocator<int>>;
+  static Vector Make() { return Vector(std::pmr::polymorphic_allocator<int>(&GetPmrResource())); }
+};
+
+// sizes of a batch: 70% inline (0 to 8), 30% spilled (9 to 64), a different order per thread
+std::vector<size_t> MakeSizes(int thread_index) {
+  std::mt19937 random(static_cast<unsigned>(thread_index) + 1);
+  std::vector<size_t> out(kBatch);
+  for (auto& size : out) {
+    size = random() % 10 < 3 ? kInline + 1 + random() % 56 : random() % (kInline + 1);
+  }
+  return out;
+}
+
+template <typename Vector>
+void Fill(Vector& vector, size_t size) {
+  for (size_t i = 0; i < size; ++i) {
+    vector.push_back(static_cast<int>(i));
+  }
+}
+
+// items_per_thread and scaling_efficiency, against the rate recorded by the 1 thread run
+// (the runs of a ThreadRange go up from 1)
+class ScalingCounters {
+  std::atomic<double>& single_thread_rate_;
+  std::chrono::steady_clock::time_point start_ = std::chrono::steady_clock::now();
+
+ public:
+  explicit ScalingCounters(std::atomic<double>& single_thread_rate)
+      : single_thread_rate_(single_thread_rate) {}
+
+  void Report(benchmark::State& state, int64_t items) {
+    const auto elapsed =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start_).count();
+    const auto rate = static_cast<double>(items) / elapsed;
+    if (ThreadCount(state) == 1) {
+      single_thread_rate_.store(rate);
+    }
+    state.SetItemsProcessed(items);
+    state.counters["items_per_thread"] =
+        benchmark::Counter(static_cast<double>(items), benchmark::Counter::kAvgThreadsRate);
+    const auto single = single_thread_rate_.load();
+    if (single > 0) {
+      state.counters["scaling_efficiency"] =
+          benchmark::Counter(rate / single, benchmark::Counter::kAvgThreads);
+    }
+  }
+};
+
+template <typename Container>
+void BM_Churn(benchmark::State& state) {
+  static std::atomic<double> single_thread_rate{0};
+  const auto sizes = MakeSizes(ThreadIndex(state));
+  ScalingCounters scaling(single_thread_rate);
+  for (auto _ : state) {
+    for (auto size : sizes) {
+      auto vector = Container::Make();
+      Fill(vector, size);
+      benchmark::DoNotOptimize(vector.data());
+    }
+  }
+  scaling.Report(state, state.iterations() * static_cast<int64_t>(kBatch));
+}
+
+// spins briefly then yields, threads may outnumber the cores
+class Backoff {
+  unsigned spins_ = 0;
+
+ public:
+  void operator()() {
+    if (++spins_ > 64) {
+      std::this_thread::yield();
+    }
+  }
+};
+
+template <typename Container>
+void BM_Handoff(benchmark::State& state) {
+  using Vector = typename Container::Vector;
+  using Queue = SBOSpscQueue<Vector, 64>;
+  static std::atomic<double> single_thread_rate{0};
+  // queue i: written by thread i, read by thread i - 1; the loop start/end are barriers
+  static std::vector<std::unique_ptr<Queue>> queues;
+  const auto threads = static_cast<size_t>(ThreadCount(state));
+  const auto index = static_cast<size_t>(ThreadIndex(state));
+  if (index == 0) {
+    queues.clear();
+    for (size_t i = 0; i < threads; ++i) {
+      queues.push_back(std::make_unique<Queue>());
+    }
+  }
+  const auto sizes = MakeSizes(ThreadIndex(state));
+  // every thread runs as many iterations and consumes all its neighbour produces, though not
+  // necessarily within the same iteration: owed counts the vectors not received yet (negative
+  // when the neighbour runs ahead)
+  int64_t owed = 0;
+  ScalingCounters scaling(single_thread_rate);
+  for (auto _ : state) {
+    auto& out = *queues[index];
+    auto& in = *queues[(index + 1) % threads];
+    owed += static_cast<int64_t>(kBatch);
+    const auto receive = [&]() {
+      auto vector = Container::Make();
+      if (!in.try_pop(vector)) {
+        return false;
+      }
+      benchmark::DoNotOptimize(vector.data());
+      --owed;
+      return true;
+    };
+    for (auto size : sizes) {
+      auto vector = Container::Make();
+      Fill(vector, size);
+      Backoff backoff;
+      while (!out.try_push(std::move(vector))) {
+        if (!receive()) {
+          backoff();
+        }
+      }
+      receive();
+    }
+    Backoff backoff;
+    while (owed > 0) {
+      if (!receive()) {
+        backoff();
+      }
+    }
+  }
+  scaling.Report(state, state.iterations() * static_cast<int64_t>(kBatch));
+}
+
+}  // namespace
+
+#define THREADED_BENCHMARKS(NAME) \
+  BENCHMARK_TEMPLATE(NAME, StdVectorStd)->ThreadRange(1, 64)->UseRealTime(); \
+  BENCHMARK_TEMPLATE(NAME, SBO8Std)->ThreadRange(1, 64)->UseRealTime(); \
+  BENCHMARK_TEMPLATE(NAME, SBO8Pool)->ThreadRange(1, 64)->UseRealTime(); \
+  BENCHMARK_TEMPLATE(NAME, SBO8Pmr)->ThreadRange(1, 64)->UseRealTime()
+
+THREADED_BENCHMARKS(BM_Churn);
+THREADED_BENCHMARKS(BM_Handoff);
@@ -4,6 +4,7 @@
 #include <gtest/gtest.h>
 
 #include "sbovector.hpp"
+#include "test_types.hpp"
 
 #include <memory>
 #include <mutex>
@@ -63,35 +64,6 @@ struct CustomAllocator {
   bool operator!=(const CustomAllocator& that) const { return this != &that; }
 };
 
-using Trivial = int;
-class NonTrivial {
- private:
-  std::unique_ptr<int> val_;
-
- public:
-  NonTrivial() noexcept { val_ = std::make_unique<int>(42); }
-
-  ~NonTrivial() {}
-
-  NonTrivial(const NonTrivial&) noexcept : NonTrivial() {}
-
-  NonTrivial(NonTrivial&&) noexcept : NonTrivial() {}
-
-  NonTrivial& operator=(const NonTrivial&) noexcept { return *this; }
-
-  NonTrivial& operator=(NonTrivial&&) noexcept { return *this; }
-};
-
-class MoveOnly {
- public:
-  MoveOnly() noexcept {}
-  ~MoveOnly() {}
-  MoveOnly(const MoveOnly&) = delete;
-  MoveOnly(MoveOnly&&) noexcept {}
-  MoveOnly& operator=(const MoveOnly&) = delete;
-  MoveOnly& operator=(MoveOnly&&) noexcept { return *this; }
-};
-
 // NOTE: Requires Synchonization, see: DataTypeOperationTrackingSBOVector::SharedDataMutex
 struct OperationCounter {
   struct OperationTotals {
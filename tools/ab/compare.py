@@ -0,0 +1,136 @@
+#!/usr/bin/env python3
+"""Judges an ab_benchmarks JSON file: current sbovector.hpp against the baseline snapshot.
+
+For every benchmark the rounds give paired samples (current and baseline ran next to each
+other); the change is the median of the per round current / baseline time ratios and its
+significance a two sided Wilcoxon signed rank test on their logs (exact up to 50 rounds).
+
+A benchmark regresses when it is slower by more than --threshold with p < --alpha, or when
+it allocates more per iteration (allocation counts are deterministic, no test needed).
+Exits 1 if anything regressed, 2 on bad input.
+
+usage: compare.py ab.json [--threshold 0.05] [--alpha 0.01] [--metric cpu_ns|real_ns]
+"""
+
+import argparse
+import json
+import math
+import statistics
+import sys
+from collections import defaultdict
+
+
+def ranks(values):
+    """1 based ranks of values, ties sharing their average rank."""
+    order = sorted(range(len(values)), key=lambda i: values[i])
+    out = [0.0] * len(values)
+    i = 0
+    while i < len(order):
+        j = i
+        while j + 1 < len(order) and values[order[j + 1]] == values[order[i]]:
+            j += 1
+        for k in range(i, j + 1):
+            out[order[k]] = (i + j) / 2.0 + 1.0
+        i = j + 1
+    return out
+
+
+def wilcoxon_p(differences):
+    """Two sided p value of the Wilcoxon signed rank test, zero differences dropped."""
+    differences = [d for d in differences if d != 0.0]
+    n = len(differences)
+    if n == 0:
+        return 1.0
+    rank = ranks([abs(d) for d in differences])
+    w_plus = sum(r for r, d in zip(rank, differences) if d > 0)
+    if n <= 50:
+        # exact null distribution over doubled (integer, tie safe) ranks
+        doubled = [int(round(2 * r)) for r in rank]
+        total = sum(doubled)
+        counts = [0] * (total + 1)
+        counts[0] = 1
+        for r in doubled:
+            for s in range(total, r - 1, -1):
+                counts[s] += counts[s - r]
+        observed = int(round(2 * w_plus))
+        extreme = min(observed, total - observed)
+        tail = sum(counts[: extreme + 1]) / float(2 ** n)
+        return min(1.0, 2.0 * tail)
+    mean = n * (n + 1) / 4.0
+    ties = defaultdict(int)
+    for r in rank:
+        ties[r] += 1
+    variance = n * (n + 1) * (2 * n + 1) / 24.0 - sum(t ** 3 - t for t in ties.values()) / 48.0
+    z = (abs(w_plus - mean) - 0.5) / math.sqrt(variance)
+    return math.erfc(max(z, 0.0) / math.sqrt(2.0))
+
+
+def load(path, metric):
+    """{name: {round: {variant: sample}}} from an ab_benchmarks file."""
+    with open(path) as f:
+        data = json.load(f)
+    by_name = defaultdict(lambda: defaultdict(dict))
+    for sample in data["samples"]:
+        if metric not in sample:
+            raise KeyError("sample without %s: %s" % (metric, sample.get("name")))
+        by_name[sample["name"]][sample["round"]][sample["variant"]] = sample
+    return by_name
+
+
+def compare(by_name, metric, threshold, alpha):
+    rows = []
+    for name in sorted(by_name):
+        pairs = [r for r in by_name[name].values() if "current" in r and "baseline" in r]
+        if not pairs:
+            continue
+        log_ratios = [math.log(p["current"][metric] / p["baseline"][metric])
+                      for p in pairs if p["current"][metric] > 0 and p["baseline"][metric] > 0]
+        change = math.exp(statistics.median(log_ratios)) - 1.0 if log_ratios else 0.0
+        p_value = wilcoxon_p(log_ratios)
+        current_allocs = statistics.mean(p["current"]["counters"].get("allocs", 0.0) for p in pairs)
+        baseline_allocs = statistics.mean(p["baseline"]["counters"].get("allocs", 0.0) for p in pairs)
+        reasons = []
+        if change > threshold and p_value < alpha:
+            reasons.append("slower")
+        if current_allocs > baseline_allocs + 1e-9:
+            reasons.append("allocates more")
+        rows.append((name, len(pairs), change, p_value, baseline_allocs, current_allocs, reasons))
+    return rows
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("path", help="ab_benchmarks --ab_out file")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="slowdown (fraction) tolerated before a significant change fails")
+    parser.add_argument("--alpha", type=float, default=0.01, help="significance level")
+    parser.add_argument("--metric", choices=("cpu_ns", "real_ns"), default="cpu_ns")
+    args = parser.parse_args()
+
+    try:
+        rows = compare(load(args.path, args.metric), args.metric, args.threshold, args.alpha)
+    except (OSError, ValueError, KeyError) as error:
+        print("compare.py: %s" % error, file=sys.stderr)
+        return 2
+    if not rows:
+        print("compare.py: no paired samples in %s" % args.path, file=sys.stderr)
+        return 2
+
+    width = max(len(row[0]) for row in rows)
+    print("%-*s %6s %9s %8s %15s" % (width, "benchmark", "rounds", "change", "p", "allocs b -> c"))
+    regressions = 0
+    for name, rounds, change, p_value, baseline_allocs, current_allocs, reasons in rows:
+        regressions += bool(reasons)
+        print("%-*s %6d %+8.1f%% %8.4f %6.2f -> %5.2f %s" % (
+            width, name, rounds, 100.0 * change, p_value, baseline_allocs, current_allocs,
+            "REGRESSION (%s)" % ", ".join(reasons) if reasons else ""))
+    min_p = 2.0 / 2 ** min(row[1] for row in rows)
+    if min_p >= args.alpha:
+        print("note: with %d rounds p cannot go below %.4f, no slowdown can be significant at "
+              "alpha %g (use more --ab_rounds)" % (min(row[1] for row in rows), min_p, args.alpha))
+    print("%d of %d benchmarks regressed" % (regressions, len(rows)))
+    return 1 if regressions else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())